@@ -0,0 +1,2922 @@
+/*
+ *  libawave.c
+ *  Part of Standing Wave 3
+ *  Plain C audio rendering library
+ *
+ *  maxlord@gmail.com
+ *
+ */
+
+/**
+ * The DSP routines of Standing Wave, with no dependency on Flash. See libawave.h.
+ * 
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <limits.h>
+
+#include "libawave.h"
+
+static float twopi = 6.2831853071795864769252867665590058;
+
+// A *large* lookup table for midi note number to frequency conversion
+// 64 steps for each of the 128 midi note numbers, large enough to not interpolate
+static float noteToFreqLookup[8192];
+
+// Another *large* lookup table for db to amplitude factor conversion
+// Goes from -128 to +128 db, which is kind of ridiculous, but
+//  provides 32 steps per db which probably enables us to do without interpolation
+static float dbToPowerLookup[8192];
+
+// One cycle of a sine for the oscillators, with a guard point so that interpolation never overruns
+#define SINE_TABLE_SIZE 4096
+static float sineTable[SINE_TABLE_SIZE + 1];
+
+// Scratch buffers for random stuff
+static float scratch1[16384];
+
+static inline float interpolate(float sample1, float sample2, float fraction) {
+	return sample1 + fraction * (sample2-sample1);
+}
+
+// We use splines for modulation shapes, typically ~ 1 point per 1024k buffer
+// These are temporarily expanded into scratch memory and run continuous modulations
+
+/* Cubic spline interpolation */
+static inline float cubicInterpolate( float y0, float y1, float y2, float y3, float mu) {
+   float a0,a1,a2,a3,mu2;
+   mu2 = mu*mu;
+   a0 = y3 - y2 - y0 + y1;
+   a1 = y0 - y1 - a0;
+   a2 = y2 - y0;
+   a3 = y1;
+   return(a0*mu*mu2+a1*mu2+a2*mu+a3);
+}
+
+/* Expand a spline segment given by its four points into a buffer */
+static int expandSplineValues(float y0, float y1, float y2, float y3, float *buffer, int frames) 
+{
+	float p, incr;
+	int count;
+	incr = 1 / (float) frames;
+	count = frames;
+	p = 0;
+	// Optimize continuous, linear, and cubic modes
+	if (y0 == 0 && y1 == 0 && y2 == 0 && y3 == 0 ) {
+		// All values are zero
+		memset(buffer, 0, frames * 4);
+	} else if (y0 == y1 && y1 == y2 && y2 == y3) {
+		// All values are the same
+		while (count--) {
+			*buffer++ = y1;
+		}
+	} else if (y0 == y1 && y2 == y3) {
+		// Linear interpolation
+		while (count--) {
+			*buffer++ = interpolate(y1, y2, p);
+			p += incr;
+		}
+	} else {
+		// This is a full spline segment
+		// Loop over the whole segment and calc instantaneous spline values with cubic interpolation
+		while (count--) {
+			*buffer++ = cubicInterpolate(y0, y1, y2, y3, p);
+			p += incr;
+		}
+	}
+	return 0;
+}
+
+/* Returns a frequency in Hz for a midi note number */
+static inline float noteToFreq(float note) {
+	return noteToFreqLookup[ (int)(note*64) ];
+}
+
+/* Returns an amplitude factor for a decibel gain number (from -128db to +128 db) */
+static inline float dbToPower(float dbGain) {
+	return dbToPowerLookup[ (int)(dbGain*32) + 4096 ];
+}
+
+/* Returns a frequency shift factor from a semitone shift number -- ie. +12 semitones = 2x frequency */
+static inline float shiftToFreq(float shift) {
+	// Yea, obscurity zone
+	return noteToFreqLookup[ (int)((69+shift)*64) ] * .00227273;
+}
+
+/**
+ * Sample memory accounting
+ * Every block of sample memory is preceded by a small header recording its size and owner category,
+ * so that the live bytes in each category are known exactly, and a budget can be enforced.
+ */
+typedef struct {
+	int bytes;
+	int category;
+	int reserved[2];     // keeps sample memory 16 byte aligned
+} MemoryHeader;
+
+static int memoryUsage[AWAVE_MEMORY_CATEGORIES];
+static int memoryTotal = 0;
+static int memoryBudget = 0;  // 0 for no budget
+
+static inline MemoryHeader *memoryHeader(float *buffer) {
+	return ((MemoryHeader *) buffer) - 1;
+}
+
+/* Returns true if growing sample memory by this many bytes would exceed the budget */
+static inline int overBudget(int bytes) {
+	return memoryBudget > 0 && bytes > 0 && memoryTotal + bytes > memoryBudget;
+}
+
+/* Resizes a block of sample memory, keeping its category. Returns 0, leaving the block alone, on failure. */
+static float *resizeSampleMemory(float *buffer, int newsize)
+{
+	MemoryHeader *header = memoryHeader(buffer);
+	int delta = newsize - header->bytes;
+	
+	if (overBudget(delta)) {
+		return 0;
+	}
+	// realloc is slow :(
+	header = (MemoryHeader *) realloc(header, sizeof(MemoryHeader) + newsize);
+	if (!header) {
+		return 0;
+	}
+	header->bytes = newsize;
+	memoryUsage[header->category] += delta;
+	memoryTotal += delta;
+	return (float *) (header + 1);
+}
+
+/**
+ * Returns a pointer to the memory allocated for this sample.
+ * Every frame value is a float, as Flash's native sound format is a 32bit float
+ *  and we don't want to waste time converting back and forth to doubles.
+ * The sample is zeroed.
+ * Stereo samples are interleaved.
+ * New memory is counted as transient. Returns 0 if the memory would exceed the budget.
+ */ 
+float *awaveAllocateSampleMemory(int frames, int channels, int zero)
+{
+	int size;
+	MemoryHeader *header;
+	float *buffer;
+ 
+	size = frames * channels * sizeof(float);
+	if (overBudget(size)) {
+		return 0;
+	}
+	header = (MemoryHeader *) malloc(sizeof(MemoryHeader) + size); 
+	if (!header) {
+		return 0;
+	}
+	header->bytes = size;
+	header->category = AWAVE_MEMORY_TRANSIENT;
+	memoryUsage[AWAVE_MEMORY_TRANSIENT] += size;
+	memoryTotal += size;
+	buffer = (float *) (header + 1);
+	
+	// If zero is true, then we must zero out this sample
+	// Otherwise, it is more efficient to leave it full of junk, if it's going to be overwritten
+	if (zero) {
+		memset(buffer, 0, size);
+	}
+	
+	return buffer;
+}
+
+/**
+ * Increases the memory allocation for this sample pointer.
+ * Returns 0 if the memory could not be grown, in which case the old memory is still valid.
+ */
+float *awaveReallocateSampleMemory(float *buffer, int oldframes, int newframes, int channels)
+{
+	int newsize;
+	int oldsize;
+ 
+	oldsize = oldframes * channels * sizeof(float);
+	newsize = newframes * channels * sizeof(float);
+	
+	buffer = resizeSampleMemory(buffer, newsize); 
+	
+	// zero out the new memory
+	if(buffer) {
+	  memset( buffer + oldframes*channels, 0, newsize - oldsize);
+  }
+	
+	return buffer;
+}
+
+void awaveFreeSampleMemory(float *buffer)
+{
+	MemoryHeader *header;
+	
+	if (!buffer) {
+		return;
+	}
+	header = memoryHeader(buffer);
+	memoryUsage[header->category] -= header->bytes;
+	memoryTotal -= header->bytes;
+	free(header);
+}
+
+/* Moves a block of sample memory to another owner category */
+void awaveSetMemoryCategory(float *buffer, int category)
+{
+	MemoryHeader *header = memoryHeader(buffer);
+	
+	if (category < 0 || category >= AWAVE_MEMORY_CATEGORIES) {
+		return;
+	}
+	memoryUsage[header->category] -= header->bytes;
+	header->category = category;
+	memoryUsage[category] += header->bytes;
+}
+
+int awaveMemoryCategory(float *buffer)
+{
+	return memoryHeader(buffer)->category;
+}
+
+/* Live bytes of sample memory in a category, or in all categories if category is AWAVE_MEMORY_ALL */
+int awaveMemoryUsage(int category)
+{
+	if (category < 0 || category >= AWAVE_MEMORY_CATEGORIES) {
+		return memoryTotal;
+	}
+	return memoryUsage[category];
+}
+
+/**
+ * Sets a hard limit on the total bytes of sample memory, or 0 for no limit.
+ * Allocations that would exceed it fail; memory already allocated is not touched.
+ */
+void awaveSetMemoryBudget(int bytes)
+{
+	memoryBudget = bytes > 0 ? bytes : 0;
+}
+
+int awaveMemoryBudget(void)
+{
+	return memoryBudget;
+}
+
+/**
+ * Planar sample memory holds each channel in its own contiguous plane of planeStride frames,
+ * one after another, rather than interleaving the channels frame by frame.
+ * Resizes planar memory, moving each plane to its new position. Growing zeroes the new frames of every plane;
+ * shrinking drops the frames past the new length.
+ */
+float *awaveReallocatePlanes(float *buffer, int oldframes, int newframes, int channels)
+{
+	int c;
+	float *resized;
+	
+	if (newframes < oldframes) {
+		// Work forwards, since each plane moves down over the end of the plane before it,
+		// and pack them before the memory shrinks out from under the later planes
+		for (c = 1; c < channels; c++) {
+			memmove(buffer + c * newframes, buffer + c * oldframes, newframes * sizeof(float));
+		}
+		resized = resizeSampleMemory(buffer, newframes * channels * sizeof(float));
+		// The planes are already packed, so the old memory still serves if it could not be shrunk
+		return resized ? resized : buffer;
+	}
+	
+	buffer = resizeSampleMemory(buffer, newframes * channels * sizeof(float));
+	if (!buffer) {
+		return 0;
+	}
+	
+	// Work backwards, since each plane moves up into memory that may still hold the plane after it
+	for (c = channels - 1; c >= 0; c--) {
+		memmove(buffer + c * newframes, buffer + c * oldframes, oldframes * sizeof(float));
+		memset(buffer + c * newframes + oldframes, 0, (newframes - oldframes) * sizeof(float));
+	}
+	return buffer;
+}
+
+/**
+ * Writes planar sample memory out as interleaved frames.
+ */
+void awaveInterleave(float *buffer, float *planes, int channels, int frames, int planeStride)
+{
+	float *left, *right;
+	int i, c;
+	
+	if (channels == 1) {
+		memcpy(buffer, planes, frames * sizeof(float));
+	} else if (channels == 2) {
+		left = planes;
+		right = planes + planeStride;
+		for (i = 0; i < frames; i++) {
+			buffer[2*i] = left[i];
+			buffer[2*i+1] = right[i];
+		}
+	} else {
+		for (c = 0; c < channels; c++) {
+			for (i = 0; i < frames; i++) {
+				buffer[i*channels + c] = planes[c*planeStride + i];
+			}
+		}
+	}
+}
+
+/**
+ * Splits interleaved frames into planar sample memory.
+ */
+void awaveDeinterleave(float *planes, float *buffer, int channels, int frames, int planeStride)
+{
+	float *left, *right;
+	int i, c;
+	
+	if (channels == 1) {
+		memcpy(planes, buffer, frames * sizeof(float));
+	} else if (channels == 2) {
+		left = planes;
+		right = planes + planeStride;
+		for (i = 0; i < frames; i++) {
+			left[i] = buffer[2*i];
+			right[i] = buffer[2*i+1];
+		}
+	} else {
+		for (c = 0; c < channels; c++) {
+			for (i = 0; i < frames; i++) {
+				planes[c*planeStride + i] = buffer[i*channels + c];
+			}
+		}
+	}
+}
+
+/**
+ * Copies one channel of interleaved memory out into a contiguous buffer.
+ */
+void awaveExtractChannel(float *out, float *buffer, int channels, int channel, int frames)
+{
+	int i;
+	
+	buffer += channel;
+	if (channels == 1) {
+		memcpy(out, buffer, frames * sizeof(float));
+	} else {
+		for (i = 0; i < frames; i++) {
+			out[i] = buffer[i*channels];
+		}
+	}
+}
+
+/**
+ * Writes a contiguous buffer into one channel of interleaved memory, leaving the other channels alone.
+ */
+void awaveInsertChannel(float *buffer, float *in, int channels, int channel, int frames)
+{
+	int i;
+	
+	buffer += channel;
+	if (channels == 1) {
+		memcpy(buffer, in, frames * sizeof(float));
+	} else {
+		for (i = 0; i < frames; i++) {
+			buffer[i*channels] = in[i];
+		}
+	}
+}
+
+/**
+ * Sample handles
+ */
+ 
+struct AwaveSample {
+	float *data;
+	int channels;
+	int frames;
+	int rate;
+	int owned;       // true if data was allocated here, and should be freed with the handle
+};
+
+/* Creates a zeroed sample. Returns 0 if memory could not be allocated. */
+AwaveSample *awaveSampleCreate(int channels, int frames, int rate)
+{
+	AwaveSample *sample;
+	float *data = awaveAllocateSampleMemory(frames, channels, 1);
+	if (!data) {
+		return 0;
+	}
+	sample = awaveSampleWrap(data, channels, frames, rate);
+	if (!sample) {
+		awaveFreeSampleMemory(data);
+		return 0;
+	}
+	sample->owned = 1;
+	return sample;
+}
+
+/* Wraps sample memory owned by the caller, without copying it */
+AwaveSample *awaveSampleWrap(float *data, int channels, int frames, int rate)
+{
+	AwaveSample *sample = (AwaveSample *) malloc(sizeof(AwaveSample));
+	if (!sample) {
+		return 0;
+	}
+	sample->data = data;
+	sample->channels = channels;
+	sample->frames = frames;
+	sample->rate = rate;
+	sample->owned = 0;
+	return sample;
+}
+
+void awaveSampleDestroy(AwaveSample *sample)
+{
+	if (sample->owned) {
+		awaveFreeSampleMemory(sample->data);
+	}
+	free(sample);
+}
+
+float *awaveSampleData(AwaveSample *sample)
+{
+	return sample->data;
+}
+
+int awaveSampleChannels(AwaveSample *sample)
+{
+	return sample->channels;
+}
+
+int awaveSampleFrames(AwaveSample *sample)
+{
+	return sample->frames;
+}
+
+int awaveSampleRate(AwaveSample *sample)
+{
+	return sample->rate;
+}
+
+/**
+ * Fast sample memory copy between sample pointers
+ */
+void awaveCopy(float *buffer, float *sourceBuffer, int channels, int frames)
+{
+	memcpy(buffer, sourceBuffer, frames * channels * sizeof(float));
+}
+
+/**
+ * Render quality, set engine-wide. Draft quality trades fidelity for speed where a kernel has a
+ * cheaper method, for interactive previews.
+ */
+static int quality = AWAVE_QUALITY_FULL;
+
+void awaveSetQuality(int q)
+{
+	quality = q;
+}
+
+int awaveQuality(void)
+{
+	return quality;
+}
+
+/* Upsample 22050 Hz to 44.1k stereo with linear interpolation, for draft quality */
+static void upsampleLinear(float *buffer, float *sourceBuffer, int channels, int frames)
+{
+	int count;
+	
+	if (frames < 2) {
+		return;
+	}
+	count = frames/2 - 1;
+	if (channels == 1) {
+		while (count--) {
+			*buffer++ = *sourceBuffer;
+			*buffer++ = *sourceBuffer;
+			*buffer = (*sourceBuffer + *(sourceBuffer+1)) * 0.5f;
+			*(buffer+1) = *buffer;
+			buffer += 2; sourceBuffer++;
+		}
+		// Last set holds the final sample
+		*buffer++ = *sourceBuffer;
+		*buffer++ = *sourceBuffer;
+		*buffer++ = *sourceBuffer;
+		*buffer = *sourceBuffer;
+	} else if (channels == 2) {
+		while (count--) {
+			*buffer++ = *sourceBuffer; // left
+			*buffer++ = *(sourceBuffer+1); // right
+			*buffer++ = (*sourceBuffer + *(sourceBuffer+2)) * 0.5f;
+			*buffer++ = (*(sourceBuffer+1) + *(sourceBuffer+3)) * 0.5f;
+			sourceBuffer += 2;
+		}
+		*buffer++ = *sourceBuffer;
+		*buffer++ = *(sourceBuffer+1);
+		*buffer++ = *sourceBuffer;
+		*buffer = *(sourceBuffer+1);
+	}
+}
+
+/**
+ * Converts a Sample at a lower rate (22050 Hz) or lower number of channels (mono)
+ *  to the standard Flash sound format (44.1k stereo interleaved).
+ * The descriptor in this case represents the sourceBuffer, not the targetBuffer, which is stereo/44.1
+ * At draft quality, upsampling is linear rather than cubic.
+ */
+void awaveStandardize(float *buffer, float *sourceBuffer, int channels, int frames, int rate) 
+{
+	int count;
+
+	if (rate == 22050 && quality == AWAVE_QUALITY_DRAFT) {
+		// Draft quality upsamples linearly instead of with cubic interpolation
+		upsampleLinear(buffer, sourceBuffer, channels, frames);
+		return;
+	}
+	if (rate == 44100 && channels == 2) {
+		// We're already standardized. Just copy the memory
+		memcpy(buffer, sourceBuffer, frames * channels * sizeof(float));
+	} else if (rate == 22050 && channels == 1) {
+		// Upsample and stereoize with cubic interpolation
+		// First set hold first sample
+		*buffer++ = *sourceBuffer;
+		*buffer++ = *sourceBuffer;
+		*buffer++ = cubicInterpolate(*(sourceBuffer), *(sourceBuffer), *(sourceBuffer+1), *(sourceBuffer+2), 0.5); 
+		*buffer = *(buffer-1);
+		buffer++; sourceBuffer++;
+		// Loop
+		count = (frames/2) - 2;
+		while (--count) {
+			*buffer++ = *sourceBuffer;
+			*buffer++ = *sourceBuffer;
+			*buffer++ = cubicInterpolate(*(sourceBuffer-1), *sourceBuffer, *(sourceBuffer+1), *(sourceBuffer+2), 0.5); 
+			*buffer = *(buffer-1);
+			buffer++; sourceBuffer++;
+		}		
+		// Last set hold 2 samples
+		*buffer++ = *sourceBuffer;
+		*buffer++ = *sourceBuffer;
+		*buffer++ = cubicInterpolate(*(sourceBuffer-1), *sourceBuffer, *(sourceBuffer+1), *(sourceBuffer+1), 0.5); 
+		*buffer = *(buffer-1);
+		buffer++; sourceBuffer++;
+		*buffer++ = *sourceBuffer;
+		*buffer++ = *sourceBuffer;
+		*buffer++ = cubicInterpolate(*(sourceBuffer-1), *sourceBuffer, *sourceBuffer, *sourceBuffer, 0.5); 
+		*buffer = *(buffer-1);
+		// Done
+	} else if (rate == 22050 && channels == 2) {
+		// Upsample with cubic interpolation 
+		// First set hold sample
+		*buffer++ = *sourceBuffer;
+		*buffer++ = *(sourceBuffer+1);
+		*buffer++ = cubicInterpolate(*sourceBuffer, *sourceBuffer, *(sourceBuffer+2), *(sourceBuffer+4), 0.5); 
+		*buffer = cubicInterpolate(*(sourceBuffer+1), *(sourceBuffer+1), *(sourceBuffer+3), *(sourceBuffer+5), 0.5); 
+		buffer++;
+		sourceBuffer += 2;
+		count = frames/2 - 2;
+		while (--count) {
+			*buffer++ = *sourceBuffer; // left
+			*buffer++ = *(sourceBuffer+1); // right
+			*buffer++ = cubicInterpolate(*(sourceBuffer-2), *sourceBuffer, *(sourceBuffer+2), *(sourceBuffer+4), 0.5); 
+			*buffer++ = cubicInterpolate(*(sourceBuffer-1), *(sourceBuffer+1), *(sourceBuffer+3), *(sourceBuffer+5), 0.5);
+			sourceBuffer += 2;
+		}
+		// second to last set		
+		*buffer++ = *sourceBuffer; // left
+		*buffer++ = *(sourceBuffer+1); // right
+		*buffer++ = cubicInterpolate(*(sourceBuffer-2), *sourceBuffer, *(sourceBuffer+2), *(sourceBuffer+2), 0.5); 
+		*buffer++ = cubicInterpolate(*(sourceBuffer-1), *(sourceBuffer+1), *(sourceBuffer+3), *(sourceBuffer+3), 0.5);
+		sourceBuffer += 2;
+		// last set
+		*buffer++ = *sourceBuffer; // left
+		*buffer++ = *(sourceBuffer+1); // right
+		*buffer++ = cubicInterpolate(*(sourceBuffer-2), *sourceBuffer, *sourceBuffer, *sourceBuffer, 0.5); 
+		*buffer= cubicInterpolate(*(sourceBuffer-1), *(sourceBuffer+1), *(sourceBuffer+1), *(sourceBuffer+1), 0.5);
+		// Done
+	} else if (rate == 44100 && channels == 1) {
+		// Stereoize
+		count = frames;
+		while (--count) {
+			*buffer++ = *sourceBuffer;
+			*buffer++ = *sourceBuffer++;
+		}
+	}
+}
+
+/**
+ * Set every sample in the range to a fixed value.
+ * Useful for function generators of different types, or erasing audio.
+ */ 
+void awaveSetSamples(float *buffer, int channels, int frames, float value)
+{
+	int count, count16, remainder;
+	
+	count = frames * channels;
+	count16 = count / 16;
+	remainder = count % 16;
+	
+	while (count16--) {
+		*buffer++ = value;
+		*buffer++ = value;
+		*buffer++ = value;
+		*buffer++ = value;
+		*buffer++ = value;
+		*buffer++ = value;
+		*buffer++ = value;
+		*buffer++ = value;
+		*buffer++ = value;
+		*buffer++ = value;
+		*buffer++ = value;
+		*buffer++ = value;
+		*buffer++ = value;
+		*buffer++ = value;
+		*buffer++ = value;
+		*buffer++ = value;
+	} 
+	while (remainder--) {
+		*buffer++ = value;
+	}
+}
+
+// Scale all samples
+void awaveChangeGain(float *buffer, int channels, int frames, float leftGain, float rightGain)
+{
+	int count;
+
+	count = frames;
+	if (channels == 1) {
+		while (count--) {
+			// *buffer++ *= leftGain; 
+			buffer[count] = buffer[count] * leftGain;
+		}
+	} else if (channels == 2) {
+		while (count--) {
+			*buffer++ *= leftGain; 
+			*buffer++ *= rightGain;
+		}
+	}
+}
+
+// Mix one buffer into another
+void awaveMixIn(float *buffer, float *sourceBuffer, int channels, int frames, float leftGain, float rightGain)
+{
+	int count, count8, remainder;
+	
+	count = frames;
+	count8 = count / 8;
+	remainder = count % 8;
+	
+	if (channels == 1) {
+		while (count8--) {
+			*buffer++ += *sourceBuffer++ * leftGain;
+			*buffer++ += *sourceBuffer++ * leftGain;
+			*buffer++ += *sourceBuffer++ * leftGain;
+			*buffer++ += *sourceBuffer++ * leftGain;
+			*buffer++ += *sourceBuffer++ * leftGain;
+			*buffer++ += *sourceBuffer++ * leftGain;
+			*buffer++ += *sourceBuffer++ * leftGain;
+			*buffer++ += *sourceBuffer++ * leftGain; 
+		}			
+		while (remainder--) {
+			*buffer++ += *sourceBuffer++ * leftGain; 
+		}
+	} else if (channels == 2) {
+		while (count8--) {
+			*buffer++ += *sourceBuffer++ * leftGain; 		
+			*buffer++ += *sourceBuffer++ * rightGain;
+			*buffer++ += *sourceBuffer++ * leftGain; 		
+			*buffer++ += *sourceBuffer++ * rightGain;
+			*buffer++ += *sourceBuffer++ * leftGain; 		
+			*buffer++ += *sourceBuffer++ * rightGain;
+			*buffer++ += *sourceBuffer++ * leftGain; 		
+			*buffer++ += *sourceBuffer++ * rightGain;
+			*buffer++ += *sourceBuffer++ * leftGain; 		
+			*buffer++ += *sourceBuffer++ * rightGain;
+			*buffer++ += *sourceBuffer++ * leftGain; 		
+			*buffer++ += *sourceBuffer++ * rightGain;
+			*buffer++ += *sourceBuffer++ * leftGain; 		
+			*buffer++ += *sourceBuffer++ * rightGain;
+			*buffer++ += *sourceBuffer++ * leftGain; 		
+			*buffer++ += *sourceBuffer++ * rightGain;
+		}
+		while (remainder--) {
+			*buffer++ += *sourceBuffer++ * leftGain; 		
+			*buffer++ += *sourceBuffer++ * rightGain;
+		}
+		
+	}
+}
+
+/**
+ * Mix a mono sample into a stereo sample.
+ * Buffer is stereo, and source buffer is mono.
+ */
+void awaveMixInPan(float *buffer, float *sourceBuffer, int frames, float leftGain, float rightGain)
+{
+	int count, count16, remainder;
+	
+	count = frames;
+	count16 = count / 16;
+	remainder = count % 16;
+	
+	while (count16--) {
+		*buffer++ += *sourceBuffer * leftGain; 		
+		*buffer++ += *sourceBuffer++ * rightGain;
+		*buffer++ += *sourceBuffer * leftGain; 		
+		*buffer++ += *sourceBuffer++ * rightGain;
+		*buffer++ += *sourceBuffer * leftGain; 		
+		*buffer++ += *sourceBuffer++ * rightGain;
+		*buffer++ += *sourceBuffer * leftGain; 		
+		*buffer++ += *sourceBuffer++ * rightGain;
+		*buffer++ += *sourceBuffer * leftGain; 		
+		*buffer++ += *sourceBuffer++ * rightGain;
+		*buffer++ += *sourceBuffer * leftGain; 		
+		*buffer++ += *sourceBuffer++ * rightGain;
+		*buffer++ += *sourceBuffer * leftGain; 		
+		*buffer++ += *sourceBuffer++ * rightGain;
+		*buffer++ += *sourceBuffer * leftGain; 		
+		*buffer++ += *sourceBuffer++ * rightGain;
+		*buffer++ += *sourceBuffer * leftGain; 		
+		*buffer++ += *sourceBuffer++ * rightGain;
+		*buffer++ += *sourceBuffer * leftGain; 		
+		*buffer++ += *sourceBuffer++ * rightGain;
+		*buffer++ += *sourceBuffer * leftGain; 		
+		*buffer++ += *sourceBuffer++ * rightGain;
+		*buffer++ += *sourceBuffer * leftGain; 		
+		*buffer++ += *sourceBuffer++ * rightGain;
+		*buffer++ += *sourceBuffer * leftGain; 		
+		*buffer++ += *sourceBuffer++ * rightGain;
+		*buffer++ += *sourceBuffer * leftGain; 		
+		*buffer++ += *sourceBuffer++ * rightGain;
+		*buffer++ += *sourceBuffer * leftGain; 		
+		*buffer++ += *sourceBuffer++ * rightGain;
+		*buffer++ += *sourceBuffer * leftGain; 		
+		*buffer++ += *sourceBuffer++ * rightGain;
+	}
+	while (remainder--) {
+		*buffer++ += *sourceBuffer * leftGain; 		
+		*buffer++ += *sourceBuffer++ * rightGain;
+	}
+}
+
+/**
+ * Gain ramps interpolate from a start gain to an end gain across a mix, so that a fade
+ * is applied in the same pass that accumulates the source. Exponential ramps move evenly in decibels;
+ * since they can never reach silence, gains below RAMP_FLOOR are raised to it.
+ */
+#define RAMP_FLOOR 0.00001f  // -100 dB
+
+/* Returns the per-frame step of a ramp, raising the start gain to the floor for exponential ramps */
+static inline float rampStep(float *start, float end, int frames, int curve) {
+	if (curve == AWAVE_RAMP_EXPONENTIAL) {
+		if (*start < RAMP_FLOOR) {
+			*start = RAMP_FLOOR;
+		}
+		if (end < RAMP_FLOOR) {
+			end = RAMP_FLOOR;
+		}
+		return powf(end / *start, 1.0f / frames);
+	}
+	return (end - *start) / frames;
+}
+
+/* Mix one buffer into another, with each channel's gain ramping across the buffer */
+void awaveMixInRamp(float *buffer, float *sourceBuffer, int channels, int frames,
+	float leftStart, float leftEnd, float rightStart, float rightEnd, int curve)
+{
+	float leftStep, rightStep;
+	
+	if (frames <= 0) {
+		return;
+	}
+	leftStep = rampStep(&leftStart, leftEnd, frames, curve);
+	rightStep = rampStep(&rightStart, rightEnd, frames, curve);
+	
+	if (curve == AWAVE_RAMP_EXPONENTIAL) {
+		if (channels == 1) {
+			while (frames--) {
+				*buffer++ += *sourceBuffer++ * leftStart;
+				leftStart *= leftStep;
+			}
+		} else if (channels == 2) {
+			while (frames--) {
+				*buffer++ += *sourceBuffer++ * leftStart;
+				*buffer++ += *sourceBuffer++ * rightStart;
+				leftStart *= leftStep;
+				rightStart *= rightStep;
+			}
+		}
+	} else {
+		if (channels == 1) {
+			while (frames--) {
+				*buffer++ += *sourceBuffer++ * leftStart;
+				leftStart += leftStep;
+			}
+		} else if (channels == 2) {
+			while (frames--) {
+				*buffer++ += *sourceBuffer++ * leftStart;
+				*buffer++ += *sourceBuffer++ * rightStart;
+				leftStart += leftStep;
+				rightStart += rightStep;
+			}
+		}
+	}
+}
+
+/**
+ * Mix a mono sample into a stereo sample, with each side's gain ramping across the buffer.
+ * Buffer is stereo, and source buffer is mono.
+ */
+void awaveMixInPanRamp(float *buffer, float *sourceBuffer, int frames,
+	float leftStart, float leftEnd, float rightStart, float rightEnd, int curve)
+{
+	float leftStep, rightStep;
+	
+	if (frames <= 0) {
+		return;
+	}
+	leftStep = rampStep(&leftStart, leftEnd, frames, curve);
+	rightStep = rampStep(&rightStart, rightEnd, frames, curve);
+	
+	if (curve == AWAVE_RAMP_EXPONENTIAL) {
+		while (frames--) {
+			*buffer++ += *sourceBuffer * leftStart;
+			*buffer++ += *sourceBuffer++ * rightStart;
+			leftStart *= leftStep;
+			rightStart *= rightStep;
+		}
+	} else {
+		while (frames--) {
+			*buffer++ += *sourceBuffer * leftStart;
+			*buffer++ += *sourceBuffer++ * rightStart;
+			leftStart += leftStep;
+			rightStart += rightStep;
+		}
+	}
+}
+
+/**
+ * Multiply (Amplitude modulate) one buffer against another
+ */
+void awaveMultiplyIn(float *buffer, float *sourceBuffer, int channels, int frames, float gain)
+{
+	int count, count32, remainder;
+	
+	count = frames * channels;
+	count32 = count / 32;
+	remainder = count % 32;
+	
+	while (count32--) {
+		*buffer++ *= *sourceBuffer++ * gain; 
+		*buffer++ *= *sourceBuffer++ * gain;
+		*buffer++ *= *sourceBuffer++ * gain;
+		*buffer++ *= *sourceBuffer++ * gain;
+		*buffer++ *= *sourceBuffer++ * gain;
+		*buffer++ *= *sourceBuffer++ * gain;
+		*buffer++ *= *sourceBuffer++ * gain;
+		*buffer++ *= *sourceBuffer++ * gain;
+		*buffer++ *= *sourceBuffer++ * gain; 
+		*buffer++ *= *sourceBuffer++ * gain;
+		*buffer++ *= *sourceBuffer++ * gain;
+		*buffer++ *= *sourceBuffer++ * gain;
+		*buffer++ *= *sourceBuffer++ * gain;
+		*buffer++ *= *sourceBuffer++ * gain;
+		*buffer++ *= *sourceBuffer++ * gain;
+		*buffer++ *= *sourceBuffer++ * gain;
+		*buffer++ *= *sourceBuffer++ * gain; 
+		*buffer++ *= *sourceBuffer++ * gain;
+		*buffer++ *= *sourceBuffer++ * gain;
+		*buffer++ *= *sourceBuffer++ * gain;
+		*buffer++ *= *sourceBuffer++ * gain;
+		*buffer++ *= *sourceBuffer++ * gain;
+		*buffer++ *= *sourceBuffer++ * gain;
+		*buffer++ *= *sourceBuffer++ * gain;
+		*buffer++ *= *sourceBuffer++ * gain; 
+		*buffer++ *= *sourceBuffer++ * gain;
+		*buffer++ *= *sourceBuffer++ * gain;
+		*buffer++ *= *sourceBuffer++ * gain;
+		*buffer++ *= *sourceBuffer++ * gain;
+		*buffer++ *= *sourceBuffer++ * gain;
+		*buffer++ *= *sourceBuffer++ * gain;
+		*buffer++ *= *sourceBuffer++ * gain;
+	}
+	while (remainder--) {
+		*buffer++ *= *sourceBuffer++ * gain;
+	}
+}
+
+/**
+ * Scan in a wavetable. Wavetable should be at least one longer than the table size.
+ */
+double awaveWavetableIn(float *buffer, float *sourceBuffer, int channels, int frames, int tableSize, 
+	double phaseArg, float phaseAddArg, float phaseResetArg, float y1, float y2)
+{
+	float phase, phaseAdd, phaseReset;
+	int count; 
+	int intPhase;
+	float *wavetablePosition;
+	float fractional, fractionalIncrement, instantBend;
+	
+	phaseAdd = phaseAddArg * tableSize; // num source frames to add per output frames
+	phase = (float) phaseArg * tableSize; // translate into a frame count into the table
+	phaseReset = phaseResetArg * tableSize;
+	
+	// Expand the pitch modulation into scratch
+	// expandLine(scratch1, y1, y2, frames); // draws spline segment into scratch1
+	// scratch = (float *) scratch1;	
+		
+	count=frames;
+	fractional = 0.0;
+	fractionalIncrement = 1 / (float) frames;
+	
+	if (channels == 1) {
+		while (count--) {
+			while (phase >= tableSize) {
+				if (phaseReset == -1) {
+					// no looping!
+					return phaseArg; 
+				} else {
+					// wrap phase to the loop point
+					phase -= tableSize; 
+					phase += phaseReset;
+				}
+			}
+			intPhase = (int) phase; // int phase
+			wavetablePosition = sourceBuffer + intPhase;
+			*buffer++ = interpolate(*wavetablePosition, *(wavetablePosition+1), phase - intPhase);
+			// Increment phase by adjusting phaseAdd for instantaneous pitch bend 
+			instantBend = interpolate(y1, y2, fractional);
+			fractional += fractionalIncrement;
+			phase +=  phaseAdd * shiftToFreq(instantBend); 
+		}		
+	} else if (channels == 2 ) {
+		while (count--) {
+			while (phase >= tableSize) {
+				if (phaseReset == -1) {
+					// no looping!
+					return phaseArg; 
+				} else {
+					// wrap phase to the loop point
+					phase -= tableSize; 
+					phase += phaseReset;
+				}
+			}
+			intPhase = ((int)(phase*0.5))*2; // int phase, round to even frames, for each stereo frame pair
+			wavetablePosition = sourceBuffer + intPhase;
+			*buffer++ = interpolate(*wavetablePosition, *(wavetablePosition+2), phase - intPhase);
+			*buffer++ = interpolate(*(wavetablePosition+1), *(wavetablePosition+3), phase - intPhase);
+			// Increment phase by adjusting phaseAdd for instantaneous pitch bend 
+			instantBend = interpolate(y1, y2, fractional);
+			fractional += fractionalIncrement;
+			phase +=  phaseAdd * shiftToFreq(instantBend);
+		}
+	}
+	
+	// Scale back down to a factor
+	return phase / tableSize;
+}
+
+/**
+ * Wavetable scan as above, with the pitch shift in semitones given for every frame in shift.
+ */
+double awaveWavetableInMod(float *buffer, float *sourceBuffer, int channels, int frames, int tableSize, 
+	double phaseArg, float phaseAddArg, float phaseResetArg, float *shift)
+{
+	float phase, phaseAdd, phaseReset;
+	int count; 
+	int intPhase;
+	float *wavetablePosition;
+	
+	phaseAdd = phaseAddArg * tableSize; // num source frames to add per output frames
+	phase = (float) phaseArg * tableSize; // translate into a frame count into the table
+	phaseReset = phaseResetArg * tableSize;
+	
+	count = frames;
+	if (channels == 1) {
+		while (count--) {
+			while (phase >= tableSize) {
+				if (phaseReset == -1) {
+					return phaseArg; 
+				}
+				phase -= tableSize; 
+				phase += phaseReset;
+			}
+			intPhase = (int) phase;
+			wavetablePosition = sourceBuffer + intPhase;
+			*buffer++ = interpolate(*wavetablePosition, *(wavetablePosition+1), phase - intPhase);
+			phase += phaseAdd * shiftToFreq(*shift++); 
+		}		
+	} else if (channels == 2 ) {
+		while (count--) {
+			while (phase >= tableSize) {
+				if (phaseReset == -1) {
+					return phaseArg; 
+				}
+				phase -= tableSize; 
+				phase += phaseReset;
+			}
+			intPhase = ((int)(phase*0.5))*2; // round to even frames, for each stereo frame pair
+			wavetablePosition = sourceBuffer + intPhase;
+			*buffer++ = interpolate(*wavetablePosition, *(wavetablePosition+2), phase - intPhase);
+			*buffer++ = interpolate(*(wavetablePosition+1), *(wavetablePosition+3), phase - intPhase);
+			phase += phaseAdd * shiftToFreq(*shift++);
+		}
+	}
+	return phase / tableSize;
+}
+
+/**
+ * Modulation curves
+ * A curve holds keyframes sorted by position, and is evaluated as a line or a spline through them.
+ * Voices read a curve through a cursor, the index of the keyframe starting the segment last used.
+ * The cursor moves forward with the voice, so that evaluating a block costs no search.
+ * A null curve reads as an empty one, 0 everywhere, so unmodulated voices need not allocate one.
+ */
+struct AwaveCurve {
+	int type;          // AWAVE_CURVE_LINE or AWAVE_CURVE_SPLINE
+	int count;
+	int capacity;
+	double *positions;
+	float *values;
+};
+
+AwaveCurve *awaveCurveCreate(int type)
+{
+	AwaveCurve *curve;
+	
+	curve = (AwaveCurve *) calloc(1, sizeof(AwaveCurve));
+	if (!curve) {
+		return 0;
+	}
+	curve->type = type;
+	return curve;
+}
+
+void awaveCurveDestroy(AwaveCurve *curve)
+{
+	free(curve->positions);
+	free(curve->values);
+	free(curve);
+}
+
+void awaveCurveClear(AwaveCurve *curve)
+{
+	curve->count = 0;
+}
+
+int awaveCurveCount(AwaveCurve *curve)
+{
+	return curve ? curve->count : 0;
+}
+
+/**
+ * Adds a keyframe, after any others at the same position.
+ * Keyframes are usually added in order, so the insertion point is searched for from the end.
+ * Returns 0 if out of memory.
+ */
+int awaveCurveAdd(AwaveCurve *curve, double position, float value)
+{
+	int i;
+	int capacity;
+	double *positions;
+	float *values;
+	
+	if (curve->count == curve->capacity) {
+		capacity = curve->capacity ? curve->capacity * 2 : 16;
+		positions = (double *) realloc(curve->positions, capacity * sizeof(double));
+		if (!positions) {
+			return 0;
+		}
+		curve->positions = positions;
+		values = (float *) realloc(curve->values, capacity * sizeof(float));
+		if (!values) {
+			return 0;
+		}
+		curve->values = values;
+		curve->capacity = capacity;
+	}
+	i = curve->count;
+	while (i > 0 && curve->positions[i-1] > position) {
+		i--;
+	}
+	memmove(curve->positions + i + 1, curve->positions + i, (curve->count - i) * sizeof(double));
+	memmove(curve->values + i + 1, curve->values + i, (curve->count - i) * sizeof(float));
+	curve->positions[i] = position;
+	curve->values[i] = value;
+	curve->count++;
+	return 1;
+}
+
+/* Moves a cursor to the last keyframe at or before a position, or the first keyframe if there is none */
+static inline int curveSeek(AwaveCurve *curve, int cursor, double position) {
+	if (cursor >= curve->count) {
+		cursor = curve->count - 1;
+	}
+	if (cursor < 0) {
+		cursor = 0;
+	}
+	while (cursor > 0 && curve->positions[cursor] > position) {
+		cursor--;
+	}
+	while (cursor + 1 < curve->count && curve->positions[cursor+1] <= position) {
+		cursor++;
+	}
+	return cursor;
+}
+
+/* The value of a curve at a position within the segment starting at keyframe i */
+static inline float curveAt(AwaveCurve *curve, int i, double position) {
+	double x0, x1;
+	float mu;
+	
+	if (position <= curve->positions[i] || i + 1 >= curve->count) {
+		// Held before the first keyframe and after the last
+		return curve->values[i];
+	}
+	x0 = curve->positions[i];
+	x1 = curve->positions[i+1];
+	mu = (float) ((position - x0) / (x1 - x0));
+	if (curve->type == AWAVE_CURVE_SPLINE) {
+		return cubicInterpolate(curve->values[i > 0 ? i-1 : i], curve->values[i], curve->values[i+1], 
+			curve->values[i + 2 < curve->count ? i+2 : i+1], mu);
+	}
+	return interpolate(curve->values[i], curve->values[i+1], mu);
+}
+
+/* The value of a curve at any position, found by binary search */
+float awaveCurveValue(AwaveCurve *curve, double position)
+{
+	int low, high, mid;
+	
+	if (!curve || curve->count == 0) {
+		return 0;
+	}
+	low = 0;
+	high = curve->count - 1;
+	while (low < high) {
+		mid = (low + high + 1) / 2;
+		if (curve->positions[mid] <= position) {
+			low = mid;
+		} else {
+			high = mid - 1;
+		}
+	}
+	return curveAt(curve, low, position);
+}
+
+/**
+ * Evaluates a curve at frames consecutive positions into out, starting from a cursor.
+ * Returns the cursor to continue from on the next call.
+ */
+int awaveCurveRender(AwaveCurve *curve, int cursor, double position, float *out, int frames)
+{
+	int n;
+	
+	if (!curve || curve->count == 0) {
+		memset(out, 0, frames * sizeof(float));
+		return 0;
+	}
+	while (frames > 0) {
+		cursor = curveSeek(curve, cursor, position);
+		// Run up to the next keyframe, where the segment changes
+		n = frames;
+		if (cursor + 1 < curve->count && curve->positions[cursor+1] - position < n) {
+			n = (int) ceil(curve->positions[cursor+1] - position);
+		}
+		frames -= n;
+		while (n--) {
+			*out++ = curveAt(curve, cursor, position);
+			position += 1;
+		}
+	}
+	return cursor;
+}
+
+/**
+ * Wavetable scan with the pitch shift in semitones read from a curve, starting at a position
+ * in the curve. The cursor is advanced past the scanned frames.
+ */
+double awaveWavetableInCurve(float *buffer, float *sourceBuffer, int channels, int frames, int tableSize,
+	double phase, float phaseAdd, float phaseReset, AwaveCurve *curve, int *cursor, double position)
+{
+	int block;
+	int scratchFrames = sizeof(scratch1) / sizeof(float);
+	
+	while (frames > 0) {
+		block = (frames < scratchFrames) ? frames : scratchFrames;
+		*cursor = awaveCurveRender(curve, *cursor, position, scratch1, block);
+		phase = awaveWavetableInMod(buffer, sourceBuffer, channels, block, tableSize, phase, phaseAdd, phaseReset, scratch1);
+		buffer += block * channels;
+		position += block;
+		frames -= block;
+	}
+	return phase;
+}
+
+/**
+ * Sample banks
+ * A bank is a 16 byte header of magic, version, zone count and a reserved int, then the zone table,
+ * then the zone data. Nothing here writes to the bank, so it may be read only shared memory.
+ */
+
+#define BANK_HEADER_BYTES 16
+
+/* Returns the number of zones in a bank of this many bytes, or -1 if it is not a valid bank */
+int awaveBankCheck(void *bank, int bytes)
+{
+	int *header = (int *) bank;
+	AwaveBankZone *zone;
+	int count, i, width;
+
+	if (bytes < BANK_HEADER_BYTES || header[0] != AWAVE_BANK_MAGIC || header[1] != AWAVE_BANK_VERSION) {
+		return -1;
+	}
+	count = header[2];
+	if (count < 0 || count > (bytes - BANK_HEADER_BYTES) / (int) sizeof(AwaveBankZone)) {
+		return -1;
+	}
+	for (i = 0; i < count; i++) {
+		zone = awaveBankZone(bank, i);
+		width = (zone->format == AWAVE_BANK_FLOAT) ? sizeof(float) : sizeof(short);
+		if ((zone->format != AWAVE_BANK_FLOAT && zone->format != AWAVE_BANK_SHORT)
+			|| zone->channels < 1 || zone->channels > 2 || zone->frames < 1
+			|| zone->offset % 16 || zone->offset < BANK_HEADER_BYTES + count * (int) sizeof(AwaveBankZone)
+			|| zone->offset > bytes) {
+			return -1;
+		}
+		// Bounded before multiplying, so a hostile header can't overflow into a size that matches
+		if (zone->frames > INT_MAX / (zone->channels * width)
+			|| zone->bytes != zone->frames * zone->channels * width
+			|| zone->bytes > bytes - zone->offset) {
+			return -1;
+		}
+	}
+	return count;
+}
+
+AwaveBankZone *awaveBankZone(void *bank, int index)
+{
+	return (AwaveBankZone *) ((char *) bank + BANK_HEADER_BYTES) + index;
+}
+
+/* The zone's data in the bank, which for a float zone is ready to use as sample memory */
+void *awaveBankZoneData(void *bank, AwaveBankZone *zone)
+{
+	return (char *) bank + zone->offset;
+}
+
+/* Converts a zone to float sample memory of its frames and channels */
+void awaveBankDecode(float *buffer, void *bank, AwaveBankZone *zone)
+{
+	int count = zone->frames * zone->channels;
+
+	if (zone->format == AWAVE_BANK_FLOAT) {
+		memcpy(buffer, awaveBankZoneData(bank, zone), count * sizeof(float));
+	} else {
+		awaveShortToFloat(buffer, (short *) awaveBankZoneData(bank, zone), count, 1.0f / 32768);
+	}
+}
+
+/**
+ * Oscillators
+ * These write a waveform straight into sample memory, the same signal in every channel.
+ * Phase runs from 0 to 1 over one cycle; phaseAdd is the frequency divided by the sample rate,
+ * and may be negative or a cycle or more, the phase being wrapped after every frame.
+ * The phase after the last frame is returned, for the next call to continue from.
+ */
+
+/* Sine by linear interpolation in a lookup table */
+static inline float sineAt(double phase) {
+	// In double, since a phase just under 1 rounds up to a full cycle in float
+	double position = phase * SINE_TABLE_SIZE;
+	int i = (int) position;
+	float fraction = (float) (position - i);
+	i &= SINE_TABLE_SIZE - 1;
+	return interpolate(sineTable[i], sineTable[i+1], fraction);
+}
+
+/* PolyBLEP residual of a unit step at phase 0, spread over one frame each side */
+static inline float polyBlep(float t, float dt) {
+	if (t < dt) {
+		t /= dt;
+		return t + t - t*t - 1;
+	} else if (t > 1 - dt) {
+		t = (t - 1) / dt;
+		return t*t + t + t + 1;
+	}
+	return 0;
+}
+
+/* PolyBLAMP residual of a unit change in slope per frame at phase 0, the integral of the PolyBLEP residual */
+static inline float polyBlamp(float t, float dt) {
+	if (t < dt) {
+		t = 1 - t / dt;
+		return t*t*t * (1.0f/6);
+	} else if (t > 1 - dt) {
+		t = (t - 1) / dt + 1;
+		return t*t*t * (1.0f/6);
+	}
+	return 0;
+}
+
+static inline float wrapPhase(float t) {
+	return t >= 1 ? t - 1 : t;
+}
+
+double awaveOscillator(float *buffer, int channels, int frames, int wave, double phase, double phaseAdd, float amplitude)
+{
+	float t, dt;
+	int i, c;
+	
+	phase -= floor(phase);
+	dt = (float) phaseAdd;
+	
+	// Write the first channel, then copy it to the others
+	switch (wave) {
+		case AWAVE_WAVE_SAW:
+			for (i = 0; i < frames; i++) {
+				t = (float) phase;
+				buffer[i*channels] = (2*t - 1 - polyBlep(t, dt)) * amplitude;
+				phase += phaseAdd;
+				phase -= floor(phase);
+			}
+			break;
+		case AWAVE_WAVE_SQUARE:
+			for (i = 0; i < frames; i++) {
+				t = (float) phase;
+				buffer[i*channels] = ((t < 0.5f ? 1 : -1) + polyBlep(t, dt) - polyBlep(wrapPhase(t + 0.5f), dt)) * amplitude;
+				phase += phaseAdd;
+				phase -= floor(phase);
+			}
+			break;
+		case AWAVE_WAVE_TRIANGLE:
+			// Corners at 0, where the slope rises by 8 per cycle, and at 0.5, where it falls by 8
+			for (i = 0; i < frames; i++) {
+				t = (float) phase;
+				buffer[i*channels] = (1 - 4 * fabsf(t - 0.5f) 
+					+ 8 * dt * (polyBlamp(t, dt) - polyBlamp(wrapPhase(t + 0.5f), dt))) * amplitude;
+				phase += phaseAdd;
+				phase -= floor(phase);
+			}
+			break;
+		default:
+			for (i = 0; i < frames; i++) {
+				buffer[i*channels] = sineAt(phase) * amplitude;
+				phase += phaseAdd;
+				phase -= floor(phase);
+			}
+			break;
+	}
+	for (i = 0; i < frames; i++) {
+		for (c = 1; c < channels; c++) {
+			buffer[i*channels + c] = buffer[i*channels];
+		}
+	}
+	return phase;
+}
+
+/**
+ * Noise from a xorshift generator. The state holds AWAVE_NOISE_STATE floats for each channel,
+ * whose first float holds the channel's seed bit for bit. Zeroed state seeds each channel differently,
+ * but the same for every caller; write distinct seeds to decorrelate streams. Restore it to restart the noise.
+ * Pink noise uses Paul Kellet's filter, accurate to within 0.05 dB above 9.2 Hz at 44.1k.
+ */
+void awaveNoise(float *buffer, float *stateBuffer, int channels, int frames, int color, float amplitude)
+{
+	unsigned int seed;
+	float white, *b;
+	int i, c;
+	
+	for (c = 0; c < channels; c++) {
+		b = stateBuffer + c * AWAVE_NOISE_STATE;
+		// The seed is kept in the first float of the state, bit for bit
+		memcpy(&seed, b, sizeof(seed));
+		if (seed == 0) {
+			seed = 0x9E3779B9u * (c + 1);
+		}
+		if (color == AWAVE_NOISE_PINK) {
+			for (i = c; i < frames * channels; i += channels) {
+				seed ^= seed << 13;
+				seed ^= seed >> 17;
+				seed ^= seed << 5;
+				white = (int) seed * (1.0f / 2147483648.0f);
+				b[1] = 0.99886f * b[1] + white * 0.0555179f;
+				b[2] = 0.99332f * b[2] + white * 0.0750759f;
+				b[3] = 0.96900f * b[3] + white * 0.1538520f;
+				b[4] = 0.86650f * b[4] + white * 0.3104856f;
+				b[5] = 0.55000f * b[5] + white * 0.5329522f;
+				b[6] = -0.7616f * b[6] - white * 0.0168980f;
+				buffer[i] = (b[1] + b[2] + b[3] + b[4] + b[5] + b[6] + b[7] + white * 0.5362f) * 0.11f * amplitude;
+				b[7] = white * 0.115926f;
+			}
+		} else {
+			for (i = c; i < frames * channels; i += channels) {
+				seed ^= seed << 13;
+				seed ^= seed >> 17;
+				seed ^= seed << 5;
+				buffer[i] = (int) seed * (1.0f / 2147483648.0f) * amplitude;
+			}
+		}
+		memcpy(b, &seed, sizeof(seed));
+	}
+}
+
+/**
+ * Envelope this sample with a modPoint in dbGain.
+ */
+void awaveEnvelope(float *buffer, int channels, int frames, float y0, float y1, float y2, float y3)
+{
+	float *scratch;
+	int count, count8, remainder; 
+	
+	expandSplineValues(y0, y1, y2, y3, scratch1, frames); // draws spline segment into scratch1
+	scratch = (float *) scratch1;
+
+	count = frames*channels;
+	count8 = count / 8;
+	remainder = count % 8;
+	
+	while (count8--) {
+		*buffer++ *= dbToPower(*scratch++);
+		*buffer++ *= dbToPower(*scratch++);
+		*buffer++ *= dbToPower(*scratch++);
+		*buffer++ *= dbToPower(*scratch++);
+		*buffer++ *= dbToPower(*scratch++);
+		*buffer++ *= dbToPower(*scratch++);
+		*buffer++ *= dbToPower(*scratch++);
+		*buffer++ *= dbToPower(*scratch++);
+	}
+	while (remainder--) {
+		*buffer++ *= dbToPower(*scratch++);
+	}
+}
+
+void awaveDelay(float *buffer, float *ringBuffer, int channels, int frames, int length, float dryMix, float wetMix, float feedback)
+{
+	int count; 
+	int offset = 0;
+	float echo;
+	float *echoPointer;
+	
+	count = frames * channels;
+	while (count--) {
+		if (offset > length) { 
+			offset = 0; 
+		}
+		echoPointer = ringBuffer + offset;
+		echo = *echoPointer;
+		*echoPointer = *buffer + echo*feedback;
+		*buffer = *buffer * dryMix + echo * wetMix + 1e-15 - 1e-15;
+		buffer++; offset++;
+	}		
+	
+	
+	// Shift the memory so that the echo pointer offset is the start of the buffer
+	
+	int ringSize = length * channels * sizeof(float);
+	int firstChunkSize = offset * channels * sizeof(float);
+	int secondChunkSize = ringSize - firstChunkSize;
+	float *temp = (float *) malloc(ringSize);
+	
+	// copy offset-end -> start of temp buffer	
+	memcpy(temp, ringBuffer + offset, secondChunkSize);
+
+	// copy start-offset -> second half of temp buffer
+	memcpy(temp + offset, ringBuffer, firstChunkSize);
+	
+	// copy temp buffer back to ringbuffer
+	memcpy(ringBuffer, temp, ringSize); 
+	free(temp);
+}
+
+/* biquad(samplePointer, stateBuffer, coefficients, rate, channels, frames) */ 
+
+void awaveBiquad(float *buffer, float *stateBuffer, int channels, int frames, 
+	float b0, float b1, float b2, float a1, float a2)
+{
+	int count; 
+	float lx, ly, lx1, lx2, ly1, ly2; // left delay line 
+	float rx, ry, rx1, rx2, ry1, ry2; // right delay line 
+		
+	count = frames;
+
+	if (channels == 1) {
+		lx1 = *stateBuffer;
+		lx2 = *(stateBuffer+1);
+		ly1 = *(stateBuffer+2);
+		ly2 = *(stateBuffer+3);
+		while (count--) {
+			lx = *buffer + 1e-15 - 1e-15; // input with denormals zapped
+            ly = lx*b0 + lx1*b1 + lx2*b2 - ly1*a1 - ly2*a2;
+			lx2 = lx1;
+			lx1 = lx;
+			ly2 = ly1;
+			ly1 = ly;
+            *buffer++ = ly; // output
+		}
+		*stateBuffer = lx1;
+		*(stateBuffer+1) = lx2;
+		*(stateBuffer+2) = ly1;
+		*(stateBuffer+3) = ly2;
+	} else if (channels == 2) {
+		lx1 = *stateBuffer;
+		rx1 = *(stateBuffer+1);
+		lx2 = *(stateBuffer+2);
+		rx2 = *(stateBuffer+3);
+		ly1 = *(stateBuffer+4);
+		ry1 = *(stateBuffer+5);
+		ly2 = *(stateBuffer+6);
+		ry2 = *(stateBuffer+7);
+		while (count--) {
+			lx = *buffer + 1e-15 - 1e-15; // left input
+            ly = lx*b0 + lx1*b1 + lx2*b2 - ly1*a1 - ly2*a2;
+			lx2 = lx1;
+			lx1 = lx;
+			ly2 = ly1;
+			ly1 = ly;
+            *buffer++ = ly; // left output
+			rx = *buffer + 1e-15 - 1e-15; // right input
+            ry = rx*b0 + rx1*b1 + rx2*b2 - ry1*a1 - ry2*a2;
+			rx2 = rx1;
+			rx1 = rx;
+			ry2 = ry1;
+			ry1 = ry;
+            *buffer++ = ry; // right output
+		}
+		*stateBuffer = lx1;
+		*(stateBuffer+1) = rx1;
+		*(stateBuffer+2) = lx2;
+		*(stateBuffer+3) = rx2;
+		*(stateBuffer+4) = ly1;
+		*(stateBuffer+5) = ry1;
+		*(stateBuffer+6) = ly2;
+		*(stateBuffer+7) = ry2;
+	}
+}
+
+/* Frames between coefficient calculations in a sweep. Coefficients are ramped linearly in between. */
+#define BIQUAD_CONTROL_FRAMES 32
+
+/**
+ * Calculates normalized biquad coefficients from the RBJ Audio EQ Cookbook.
+ * Writes b0, b1, b2, a1, a2 into coeffs.
+ */
+void awaveBiquadCoefficients(int type, float freq, float q, float dbGain, float rate, float *coeffs)
+{
+	float w0, cosw0, sinw0, alpha, A, sqrtA;
+	float a0, a1, a2, b0, b1, b2;
+	
+	// Keep the filter stable at the extremes
+	if (freq < 10) { freq = 10; }
+	if (freq > rate * 0.49f) { freq = rate * 0.49f; }
+	if (q < 0.01f) { q = 0.01f; }
+	
+	w0 = twopi * freq / rate;
+	cosw0 = cosf(w0);
+	sinw0 = sinf(w0);
+	alpha = sinw0 / (2 * q);
+	A = powf(10.0f, dbGain / 40);
+	
+	switch (type) {
+		case AWAVE_BIQUAD_HIGH_PASS:
+			b0 = (1 + cosw0) / 2; b1 = -(1 + cosw0); b2 = (1 + cosw0) / 2;
+			a0 = 1 + alpha; a1 = -2 * cosw0; a2 = 1 - alpha;
+			break;
+		case AWAVE_BIQUAD_BAND_PASS:
+			b0 = alpha; b1 = 0; b2 = -alpha;
+			a0 = 1 + alpha; a1 = -2 * cosw0; a2 = 1 - alpha;
+			break;
+		case AWAVE_BIQUAD_PEAK:
+			b0 = 1 + alpha*A; b1 = -2 * cosw0; b2 = 1 - alpha*A;
+			a0 = 1 + alpha/A; a1 = -2 * cosw0; a2 = 1 - alpha/A;
+			break;
+		case AWAVE_BIQUAD_LOW_SHELF:
+			sqrtA = sqrtf(A);
+			b0 = A*( (A+1) - (A-1)*cosw0 + 2*sqrtA*alpha );
+			b1 = 2*A*( (A-1) - (A+1)*cosw0 );
+			b2 = A*( (A+1) - (A-1)*cosw0 - 2*sqrtA*alpha );
+			a0 = (A+1) + (A-1)*cosw0 + 2*sqrtA*alpha;
+			a1 = -2*( (A-1) + (A+1)*cosw0 );
+			a2 = (A+1) + (A-1)*cosw0 - 2*sqrtA*alpha;
+			break;
+		case AWAVE_BIQUAD_HIGH_SHELF:
+			sqrtA = sqrtf(A);
+			b0 = A*( (A+1) + (A-1)*cosw0 + 2*sqrtA*alpha );
+			b1 = -2*A*( (A-1) + (A+1)*cosw0 );
+			b2 = A*( (A+1) + (A-1)*cosw0 - 2*sqrtA*alpha );
+			a0 = (A+1) - (A-1)*cosw0 + 2*sqrtA*alpha;
+			a1 = 2*( (A-1) - (A+1)*cosw0 );
+			a2 = (A+1) - (A-1)*cosw0 - 2*sqrtA*alpha;
+			break;
+		default: // AWAVE_BIQUAD_LOW_PASS
+			b0 = (1 - cosw0) / 2; b1 = 1 - cosw0; b2 = (1 - cosw0) / 2;
+			a0 = 1 + alpha; a1 = -2 * cosw0; a2 = 1 - alpha;
+			break;
+	}
+	
+	coeffs[0] = b0 / a0;
+	coeffs[1] = b1 / a0;
+	coeffs[2] = b2 / a0;
+	coeffs[3] = a1 / a0;
+	coeffs[4] = a2 / a0;
+}
+
+/**
+ * biquadSweep(samplePointer, stateBuffer, channels, frames, type, rate, 
+ *   startFreq, endFreq, startQ, endQ, startGain, endGain)
+ * 
+ * Runs a biquad whose coefficients are calculated here from filter parameters.
+ * The parameters move from their start to their end values across the buffer, frequency
+ * exponentially and Q and dB gain linearly, so filter sweeps are smooth and cheap.
+ * The state buffer has the same layout as for biquad().
+ */
+void awaveBiquadSweep(float *buffer, float *stateBuffer, int channels, int frames, int type, int rate,
+	float startFreq, float endFreq, float startQ, float endQ, float startGain, float endGain)
+{
+	float freqRatio, deltaQ, deltaGain, t;
+	float c[5], target[5], incr[5];
+	float lx, ly, lx1, lx2, ly1, ly2; // left delay line
+	float rx, ry, rx1, rx2, ry1, ry2; // right delay line
+	int sweeping, done, block, count, i;
+	
+	if (frames <= 0) {
+		return;
+	}
+	
+	freqRatio = (startFreq > 0 && endFreq > 0) ? endFreq / startFreq : 1;
+	deltaQ = endQ - startQ;
+	deltaGain = endGain - startGain;
+	sweeping = (startFreq != endFreq || startQ != endQ || startGain != endGain);
+	
+	awaveBiquadCoefficients(type, startFreq, startQ, startGain, (float) rate, c);
+	for (i = 0; i < 5; i++) {
+		incr[i] = 0;
+	}
+	
+	if (channels == 1) {
+		lx1 = stateBuffer[0]; lx2 = stateBuffer[1]; ly1 = stateBuffer[2]; ly2 = stateBuffer[3];
+		rx1 = rx2 = ry1 = ry2 = 0;
+	} else {
+		lx1 = stateBuffer[0]; rx1 = stateBuffer[1]; lx2 = stateBuffer[2]; rx2 = stateBuffer[3];
+		ly1 = stateBuffer[4]; ry1 = stateBuffer[5]; ly2 = stateBuffer[6]; ry2 = stateBuffer[7];
+	}
+	
+	done = 0;
+	while (done < frames) {
+		block = sweeping ? BIQUAD_CONTROL_FRAMES : frames;
+		if (block > frames - done) {
+			block = frames - done;
+		}
+		
+		// Find the coefficients at the end of this control block, and ramp towards them
+		if (sweeping) {
+			t = (float) (done + block) / frames;
+			awaveBiquadCoefficients(type, startFreq * powf(freqRatio, t), startQ + deltaQ * t, startGain + deltaGain * t, (float) rate, target);
+			for (i = 0; i < 5; i++) {
+				incr[i] = (target[i] - c[i]) / block;
+			}
+		}
+		
+		count = block;
+		if (channels == 1) {
+			while (count--) {
+				c[0] += incr[0]; c[1] += incr[1]; c[2] += incr[2]; c[3] += incr[3]; c[4] += incr[4];
+				lx = *buffer + 1e-15 - 1e-15; // input with denormals zapped
+				ly = lx*c[0] + lx1*c[1] + lx2*c[2] - ly1*c[3] - ly2*c[4];
+				lx2 = lx1; lx1 = lx;
+				ly2 = ly1; ly1 = ly;
+				*buffer++ = ly;
+			}
+		} else {
+			while (count--) {
+				c[0] += incr[0]; c[1] += incr[1]; c[2] += incr[2]; c[3] += incr[3]; c[4] += incr[4];
+				lx = *buffer + 1e-15 - 1e-15; // left input
+				ly = lx*c[0] + lx1*c[1] + lx2*c[2] - ly1*c[3] - ly2*c[4];
+				lx2 = lx1; lx1 = lx;
+				ly2 = ly1; ly1 = ly;
+				*buffer++ = ly;
+				rx = *buffer + 1e-15 - 1e-15; // right input
+				ry = rx*c[0] + rx1*c[1] + rx2*c[2] - ry1*c[3] - ry2*c[4];
+				rx2 = rx1; rx1 = rx;
+				ry2 = ry1; ry1 = ry;
+				*buffer++ = ry;
+			}
+		}
+		
+		// Land exactly on the target, so ramp error doesn't accumulate
+		if (sweeping) {
+			for (i = 0; i < 5; i++) {
+				c[i] = target[i];
+			}
+		}
+		done += block;
+	}
+	
+	if (channels == 1) {
+		stateBuffer[0] = lx1; stateBuffer[1] = lx2; stateBuffer[2] = ly1; stateBuffer[3] = ly2;
+	} else {
+		stateBuffer[0] = lx1; stateBuffer[1] = rx1; stateBuffer[2] = lx2; stateBuffer[3] = rx2;
+		stateBuffer[4] = ly1; stateBuffer[5] = ry1; stateBuffer[6] = ly2; stateBuffer[7] = ry2;
+	}
+}
+
+/* Branch-free clamp, which compilers turn into min and max instructions */
+static inline float clampSample(float x, float lo, float hi) {
+	x = (x < lo) ? lo : x;
+	return (x > hi) ? hi : x;
+}
+
+/* Fast tangent-shaped approximation drive curve, which reaches exactly +/-1 at +/-3 */
+static inline float overdriveCurve(float x) {
+	x = clampSample(x, -3.0f, 3.0f);
+	return x * ( 27 + x * x ) / ( 27 + 9 * x * x );
+}
+
+/**
+ * Saturator stage
+ */
+void awaveOverdrive(float *buffer, int channels, int frames)
+{
+	int i;
+	int count = frames*channels;
+	
+	for (i = 0; i < count; i++) {
+		buffer[i] = overdriveCurve(buffer[i]);
+	}
+}
+
+/**
+ * Normalize volume to digital full scale -1 to 1
+ */
+void awaveNormalize(float *buffer, int channels, int frames, float desiredMaxAmp)
+{
+	float *start = buffer;
+	int count, count8, remainder; 
+	float actualMaxAmp, actualMaxAmpNeg;
+	float gainFactor;
+	
+	// Crawl the whole buffer and find the maximum sample value
+	count = frames * channels;
+	actualMaxAmp = 0.0;
+	actualMaxAmpNeg = 0.0; // maintain positive and negative limits to avoid a million calls to abs()
+	while (count--) {
+		if (*buffer > actualMaxAmp) {
+			actualMaxAmp = *buffer;
+			actualMaxAmpNeg = *buffer * -1.0;
+		} else if (*buffer < actualMaxAmpNeg) {
+			actualMaxAmp = *buffer * -1.0;
+			actualMaxAmpNeg = *buffer;
+		}
+		buffer++;
+	}
+	
+	// Calculate gain normalization factor
+	gainFactor = desiredMaxAmp / actualMaxAmp;
+	
+	// Adjust gain of entire buffer, with an unroll...
+	count = frames * channels;
+	count8 = count / 8;
+	remainder = count % 8;
+	buffer = start;
+	while (count8--) {
+		*buffer++ *= gainFactor;
+		*buffer++ *= gainFactor;
+		*buffer++ *= gainFactor;
+		*buffer++ *= gainFactor;
+		*buffer++ *= gainFactor;
+		*buffer++ *= gainFactor;
+		*buffer++ *= gainFactor;
+		*buffer++ *= gainFactor;
+	}
+	while (remainder--) {
+		*buffer++ *= gainFactor;
+	}
+}
+
+/**
+ * Hard clipper stage
+ */
+void awaveClip(float *buffer, int channels, int frames)
+{
+	int i;
+	int count = frames*channels;
+	
+	for (i = 0; i < count; i++) {
+		buffer[i] = clampSample(buffer[i], -1.0f, 1.0f);
+	}
+}
+
+/**
+ * Oversampled waveshaping
+ *
+ * A shaper runs the overdrive or clip curve at 2x or 4x the base rate, so that the harmonics the curve
+ * generates above the base Nyquist frequency are filtered out rather than aliasing back down.
+ * Each factor of 2 is a stage of polyphase halfband FIR filtering on the way up and again on the way down.
+ * The halfband filter has HALFBAND_TAPS taps in each branch, and every stage keeps its filter history
+ * in the shaper so that consecutive blocks join seamlessly.
+ */
+
+#define HALFBAND_TAPS 24        // taps in the filtering branch of the halfband filter
+#define HALFBAND_CENTER 12      // HALFBAND_TAPS / 2
+#define SHAPER_CHUNK 256        // base rate frames shaped at a time
+
+// The odd taps of a windowed sinc halfband filter. The even taps are all zero, except for the center tap of 0.5
+static float halfbandTable[HALFBAND_TAPS];
+
+struct AwaveShaper {
+	int curve;          // AWAVE_SHAPE_OVERDRIVE or AWAVE_SHAPE_CLIP
+	int channels;
+	int stages;         // 0, 1 or 2 halfband stages for 1x, 2x or 4x
+	float upHistory[2][2][HALFBAND_TAPS];   // [stage][channel] input history of the upsamplers
+	float downOdd[2][2][HALFBAND_TAPS];     // odd input history of the downsamplers
+	float downEven[2][2][HALFBAND_CENTER];  // even input history of the downsamplers
+	float bufferA[4 * SHAPER_CHUNK];        // one channel of oversampled signal
+	float bufferB[4 * SHAPER_CHUNK];
+	float odd[HALFBAND_TAPS + 2 * SHAPER_CHUNK];      // filter input, preceded by its history
+	float even[HALFBAND_CENTER + 2 * SHAPER_CHUNK];
+};
+
+/* Doubles the rate of frames samples from input into output */
+static void halfbandUp(AwaveShaper *shaper, float *history, float *input, float *output, int frames)
+{
+	float *x = shaper->odd;
+	float acc;
+	int m, i;
+	
+	memcpy(x, history, HALFBAND_TAPS * sizeof(float));
+	memcpy(x + HALFBAND_TAPS, input, frames * sizeof(float));
+	
+	for (m = 0; m < frames; m++) {
+		// x points one past the current input sample
+		x++;
+		acc = 0;
+		for (i = 0; i < HALFBAND_TAPS; i++) {
+			acc += halfbandTable[i] * x[HALFBAND_TAPS - 1 - i];
+		}
+		output[2*m] = 2 * acc;
+		output[2*m+1] = x[HALFBAND_CENTER];
+	}
+	
+	memcpy(history, shaper->odd + frames, HALFBAND_TAPS * sizeof(float));
+}
+
+/* Halves the rate of frames*2 samples from input into output */
+static void halfbandDown(AwaveShaper *shaper, float *oddHistory, float *evenHistory, float *input, float *output, int frames)
+{
+	float *x = shaper->odd;
+	float *even = shaper->even;
+	float acc;
+	int m, i;
+	
+	memcpy(x, oddHistory, HALFBAND_TAPS * sizeof(float));
+	memcpy(even, evenHistory, HALFBAND_CENTER * sizeof(float));
+	for (m = 0; m < frames; m++) {
+		even[HALFBAND_CENTER + m] = input[2*m];
+		x[HALFBAND_TAPS + m] = input[2*m+1];
+	}
+	
+	for (m = 0; m < frames; m++) {
+		acc = 0;
+		for (i = 0; i < HALFBAND_TAPS; i++) {
+			acc += halfbandTable[i] * x[m + 1 + i];
+		}
+		output[m] = acc + 0.5f * even[m + 1];
+	}
+	
+	memcpy(oddHistory, x + frames, HALFBAND_TAPS * sizeof(float));
+	memcpy(evenHistory, even + frames, HALFBAND_CENTER * sizeof(float));
+}
+
+/**
+ * Creates a shaper for a curve, oversampled by a factor of 1, 2 or 4.
+ * Returns 0 for an unsupported factor or channel count, or if memory could not be allocated.
+ */
+AwaveShaper *awaveShaperCreate(int curve, int channels, int oversample)
+{
+	AwaveShaper *shaper;
+	int stages;
+	
+	if (oversample == 1) {
+		stages = 0;
+	} else if (oversample == 2) {
+		stages = 1;
+	} else if (oversample == 4) {
+		stages = 2;
+	} else {
+		return 0;
+	}
+	if (channels < 1 || channels > 2) {
+		return 0;
+	}
+	
+	shaper = (AwaveShaper *) calloc(1, sizeof(AwaveShaper));
+	if (!shaper) {
+		return 0;
+	}
+	shaper->curve = curve;
+	shaper->channels = channels;
+	shaper->stages = stages;
+	return shaper;
+}
+
+void awaveShaperDestroy(AwaveShaper *shaper)
+{
+	free(shaper);
+}
+
+/* Clears the filter history, as at the start of a new signal */
+void awaveShaperReset(AwaveShaper *shaper)
+{
+	memset(shaper->upHistory, 0, sizeof(shaper->upHistory));
+	memset(shaper->downOdd, 0, sizeof(shaper->downOdd));
+	memset(shaper->downEven, 0, sizeof(shaper->downEven));
+}
+
+int awaveShaperChannels(AwaveShaper *shaper)
+{
+	return shaper->channels;
+}
+
+/**
+ * The number of base rate frames by which the shaper's output lags its input.
+ * This is not a whole number of frames when oversampling.
+ */
+float awaveShaperLatency(AwaveShaper *shaper)
+{
+	if (shaper->stages == 0) {
+		return 0;
+	} else if (shaper->stages == 1) {
+		return HALFBAND_TAPS - 1.5f;
+	} else {
+		return 1.5f * HALFBAND_TAPS - 2.25f;
+	}
+}
+
+/**
+ * Runs interleaved sample memory with the shaper's channel count through the shaper's curve
+ */
+void awaveShape(AwaveShaper *shaper, float *buffer, int frames)
+{
+	int channels = shaper->channels;
+	int offset, count, length, c, i, s;
+	float *in, *out, *swap;
+	
+	if (shaper->stages == 0) {
+		if (shaper->curve == AWAVE_SHAPE_CLIP) {
+			awaveClip(buffer, channels, frames);
+		} else {
+			awaveOverdrive(buffer, channels, frames);
+		}
+		return;
+	}
+	
+	for (offset = 0; offset < frames; offset += SHAPER_CHUNK) {
+		count = frames - offset;
+		if (count > SHAPER_CHUNK) {
+			count = SHAPER_CHUNK;
+		}
+		
+		for (c = 0; c < channels; c++) {
+			in = shaper->bufferA;
+			out = shaper->bufferB;
+			for (i = 0; i < count; i++) {
+				in[i] = buffer[(offset + i) * channels + c];
+			}
+			
+			// Up through each stage, shape, and back down again
+			length = count;
+			for (s = 0; s < shaper->stages; s++) {
+				halfbandUp(shaper, shaper->upHistory[s][c], in, out, length);
+				length *= 2;
+				swap = in; in = out; out = swap;
+			}
+			if (shaper->curve == AWAVE_SHAPE_CLIP) {
+				awaveClip(in, 1, length);
+			} else {
+				awaveOverdrive(in, 1, length);
+			}
+			for (s = shaper->stages - 1; s >= 0; s--) {
+				length /= 2;
+				halfbandDown(shaper, shaper->downOdd[s][c], shaper->downEven[s][c], in, out, length);
+				swap = in; in = out; out = swap;
+			}
+			
+			for (i = 0; i < count; i++) {
+				buffer[(offset + i) * channels + c] = in[i];
+			}
+		}
+	}
+}
+
+/**
+ * Partitioned convolution
+ *
+ * A uniformly partitioned overlap-add convolution engine, used for long FIR filters such as reverb impulses.
+ * The impulse is cut into partitions of partitionSize frames, each of which is transformed once when the
+ * impulse is prepared. The prepared impulse is reference counted and may be shared by any number of 
+ * convolution states. Each state keeps a frequency domain delay line of the spectra of its recent input blocks,
+ * so that each block of input costs one forward FFT, one multiply-accumulate pass per partition, and one inverse FFT.
+ * Output is delayed by partitionSize frames.
+ */
+
+/* Real FFT of size N, done as a complex FFT of size N/2 with a split step */
+typedef struct {
+	int size;        // real transform size N
+	int half;        // N/2, the complex transform size
+	int *bitReverse; // bit reversal permutation for the complex transform
+	float *cosTable; // complex twiddles, half/2 entries
+	float *sinTable;
+	float *splitCos; // split step twiddles, half entries
+	float *splitSin;
+} RealFFT;
+
+/* A prepared impulse response, shareable between convolution states */
+struct AwaveImpulse {
+	RealFFT fft;
+	int partitionSize;
+	int partitions;
+	int channels;
+	int bins;        // partitionSize + 1 spectral bins per partition
+	int refCount;    // the owner plus one for each state using this impulse
+	float *re;       // [channel][partition][bin]
+	float *im;
+};
+
+/* Running state of one convolution */
+struct AwaveConvolution {
+	AwaveImpulse *impulse;
+	int channels;
+	int index;       // frame position within the current block
+	int head;        // delay line slot holding the newest input spectrum
+	float *input;    // [channel][partitionSize] the block being collected
+	float *dry;      // [channel][partitionSize] the previous block, for the delayed dry signal
+	float *output;   // [channel][partitionSize] wet output for the block being collected
+	float *overlap;  // [channel][partitionSize] tail of the previous block's inverse transform
+	float *fdlRe;    // [channel][partition][bin] frequency domain delay line
+	float *fdlIm;
+	float *accRe;    // [bin] spectral accumulator
+	float *accIm;
+	float *timeRe;   // [half] complex transform work buffers
+	float *timeIm;
+};
+
+static int initRealFFT(RealFFT *fft, int size)
+{
+	int i, j, bits;
+	int half = size / 2;
+	
+	fft->size = size;
+	fft->half = half;
+	fft->bitReverse = (int *) malloc(half * sizeof(int));
+	fft->cosTable = (float *) malloc((half/2 + 1) * sizeof(float));
+	fft->sinTable = (float *) malloc((half/2 + 1) * sizeof(float));
+	fft->splitCos = (float *) malloc(half * sizeof(float));
+	fft->splitSin = (float *) malloc(half * sizeof(float));
+	if (!fft->bitReverse || !fft->cosTable || !fft->sinTable || !fft->splitCos || !fft->splitSin) {
+		return -1;
+	}
+	
+	for (bits = 0; (1 << bits) < half; bits++);
+	for (i = 0; i < half; i++) {
+		int r = 0;
+		for (j = 0; j < bits; j++) {
+			r |= ((i >> j) & 1) << (bits - 1 - j);
+		}
+		fft->bitReverse[i] = r;
+	}
+	for (i = 0; i <= half/2; i++) {
+		fft->cosTable[i] = (float) cos(2.0 * 3.14159265358979323846 * i / half);
+		fft->sinTable[i] = (float) sin(2.0 * 3.14159265358979323846 * i / half);
+	}
+	for (i = 0; i < half; i++) {
+		fft->splitCos[i] = (float) cos(2.0 * 3.14159265358979323846 * i / size);
+		fft->splitSin[i] = (float) sin(2.0 * 3.14159265358979323846 * i / size);
+	}
+	return 0;
+}
+
+static void freeRealFFT(RealFFT *fft)
+{
+	free(fft->bitReverse);
+	free(fft->cosTable);
+	free(fft->sinTable);
+	free(fft->splitCos);
+	free(fft->splitSin);
+}
+
+/* In place radix-2 complex FFT on split arrays. direction is -1 for forward, +1 for inverse (unscaled) */
+static void complexFFT(RealFFT *fft, float *re, float *im, int direction)
+{
+	int n = fft->half;
+	int i, j, k, span, step;
+	float tr, ti, wr, wi;
+	
+	for (i = 0; i < n; i++) {
+		j = fft->bitReverse[i];
+		if (j > i) {
+			tr = re[i]; re[i] = re[j]; re[j] = tr;
+			ti = im[i]; im[i] = im[j]; im[j] = ti;
+		}
+	}
+	
+	for (span = 1; span < n; span <<= 1) {
+		step = n / (span << 1);
+		for (k = 0; k < span; k++) {
+			wr = fft->cosTable[k * step];
+			wi = direction * fft->sinTable[k * step];
+			for (i = k; i < n; i += span << 1) {
+				j = i + span;
+				tr = re[j]*wr - im[j]*wi;
+				ti = re[j]*wi + im[j]*wr;
+				re[j] = re[i] - tr;
+				im[j] = im[i] - ti;
+				re[i] += tr;
+				im[i] += ti;
+			}
+		}
+	}
+}
+
+/**
+ * Forward real FFT of size N. The input is read from time, N real values.
+ * Writes N/2+1 bins into outRe/outIm. workRe and workIm are N/2 scratch arrays.
+ */
+static void realForward(RealFFT *fft, float *time, float *outRe, float *outIm, float *workRe, float *workIm)
+{
+	int half = fft->half;
+	int k;
+	float zr, zi, cr, ci, er, ei, odr, odi, wr, wi;
+	
+	// Pack even samples into the real part, odd samples into the imaginary part
+	for (k = 0; k < half; k++) {
+		workRe[k] = time[2*k];
+		workIm[k] = time[2*k+1];
+	}
+	complexFFT(fft, workRe, workIm, -1);
+	
+	// Split into the spectrum of the real sequence
+	outRe[0] = workRe[0] + workIm[0];
+	outIm[0] = 0;
+	outRe[half] = workRe[0] - workIm[0];
+	outIm[half] = 0;
+	for (k = 1; k < half; k++) {
+		zr = workRe[k]; zi = workIm[k];
+		cr = workRe[half-k]; ci = -workIm[half-k];
+		er = 0.5f * (zr + cr); ei = 0.5f * (zi + ci);      // even part
+		odr = 0.5f * (zi - ci); odi = -0.5f * (zr - cr);     // odd part
+		wr = fft->splitCos[k]; wi = -fft->splitSin[k];
+		outRe[k] = er + odr*wr - odi*wi;
+		outIm[k] = ei + odr*wi + odi*wr;
+	}
+}
+
+/**
+ * Inverse real FFT of size N, scaled so that realInverse(realForward(x)) == x.
+ * Reads N/2+1 bins from inRe/inIm and writes N real values to time.
+ */
+static void realInverse(RealFFT *fft, float *inRe, float *inIm, float *time, float *workRe, float *workIm)
+{
+	int half = fft->half;
+	int k;
+	float xr, xi, cr, ci, er, ei, dr, di, odr, odi, wr, wi;
+	float scale = 1.0f / half;
+	
+	// Undo the split step
+	for (k = 0; k < half; k++) {
+		xr = inRe[k]; xi = inIm[k];
+		cr = inRe[half-k]; ci = -inIm[half-k];
+		er = 0.5f * (xr + cr); ei = 0.5f * (xi + ci);
+		dr = 0.5f * (xr - cr); di = 0.5f * (xi - ci);
+		wr = fft->splitCos[k]; wi = fft->splitSin[k];
+		odr = dr*wr - di*wi; odi = dr*wi + di*wr;
+		workRe[k] = er - odi;
+		workIm[k] = ei + odr;
+	}
+	complexFFT(fft, workRe, workIm, 1);
+	
+	for (k = 0; k < half; k++) {
+		time[2*k] = workRe[k] * scale;
+		time[2*k+1] = workIm[k] * scale;
+	}
+}
+
+/**
+ * Transform an interleaved impulse into partition spectra.
+ * Returns 0 if the partition size is not a power of two from 2 to AWAVE_MAX_PARTITION,
+ * or if memory could not be allocated.
+ */
+AwaveImpulse *awaveImpulseCreate(float *impulse, int channels, int frames, int partitionSize)
+{
+	AwaveImpulse *ir;
+	int c, p, i, n, bins, partitions;
+	float *time, *workRe, *workIm;
+	
+	if (partitionSize < 2 || partitionSize > AWAVE_MAX_PARTITION || (partitionSize & (partitionSize - 1)) || channels < 1) {
+		return 0; // must be a power of two whose transform fits in scratch memory
+	}
+	ir = (AwaveImpulse *) calloc(1, sizeof(AwaveImpulse));
+	if (!ir) {
+		return 0;
+	}
+	partitions = (frames + partitionSize - 1) / partitionSize;
+	if (partitions < 1) {
+		partitions = 1;
+	}
+	bins = partitionSize + 1;
+	ir->partitionSize = partitionSize;
+	ir->partitions = partitions;
+	ir->channels = channels;
+	ir->bins = bins;
+	ir->refCount = 1;
+	ir->re = (float *) malloc(channels * partitions * bins * sizeof(float));
+	ir->im = (float *) malloc(channels * partitions * bins * sizeof(float));
+	time = (float *) malloc(2 * partitionSize * sizeof(float));
+	workRe = (float *) malloc(partitionSize * sizeof(float));
+	workIm = (float *) malloc(partitionSize * sizeof(float));
+	if (initRealFFT(&ir->fft, 2 * partitionSize) || !ir->re || !ir->im || !time || !workRe || !workIm) {
+		freeRealFFT(&ir->fft);
+		free(ir->re); free(ir->im);
+		free(time); free(workRe); free(workIm);
+		free(ir);
+		return 0;
+	}
+	
+	for (c = 0; c < channels; c++) {
+		for (p = 0; p < partitions; p++) {
+			// Each partition is zero padded to twice its length, so the linear convolution fits
+			memset(time, 0, 2 * partitionSize * sizeof(float));
+			for (i = 0; i < partitionSize; i++) {
+				n = p * partitionSize + i;
+				if (n >= frames) {
+					break;
+				}
+				time[i] = impulse[n * channels + c];
+			}
+			realForward(&ir->fft, time, ir->re + (c * partitions + p) * bins, ir->im + (c * partitions + p) * bins, workRe, workIm);
+		}
+	}
+	
+	free(time); free(workRe); free(workIm);
+	return ir;
+}
+
+void awaveImpulseRelease(AwaveImpulse *ir)
+{
+	if (--ir->refCount > 0) {
+		return;
+	}
+	freeRealFFT(&ir->fft);
+	free(ir->re);
+	free(ir->im);
+	free(ir);
+}
+
+AwaveConvolution *awaveConvolutionCreate(AwaveImpulse *ir, int channels)
+{
+	AwaveConvolution *state;
+	int size = ir->partitionSize;
+	int delayLine = channels * ir->partitions * ir->bins;
+	
+	state = (AwaveConvolution *) calloc(1, sizeof(AwaveConvolution));
+	if (!state) {
+		return 0;
+	}
+	state->impulse = ir;
+	state->channels = channels;
+	state->input = (float *) calloc(channels * size, sizeof(float));
+	state->dry = (float *) calloc(channels * size, sizeof(float));
+	state->output = (float *) calloc(channels * size, sizeof(float));
+	state->overlap = (float *) calloc(channels * size, sizeof(float));
+	state->fdlRe = (float *) calloc(delayLine, sizeof(float));
+	state->fdlIm = (float *) calloc(delayLine, sizeof(float));
+	state->accRe = (float *) malloc(ir->bins * sizeof(float));
+	state->accIm = (float *) malloc(ir->bins * sizeof(float));
+	state->timeRe = (float *) malloc(size * sizeof(float));
+	state->timeIm = (float *) malloc(size * sizeof(float));
+	if (!state->input || !state->dry || !state->output || !state->overlap || !state->fdlRe || !state->fdlIm
+	    || !state->accRe || !state->accIm || !state->timeRe || !state->timeIm) {
+		free(state->input); free(state->dry); free(state->output); free(state->overlap);
+		free(state->fdlRe); free(state->fdlIm); free(state->accRe); free(state->accIm);
+		free(state->timeRe); free(state->timeIm);
+		free(state);
+		return 0;
+	}
+	ir->refCount++;
+	return state;
+}
+
+void awaveConvolutionDestroy(AwaveConvolution *state)
+{
+	awaveImpulseRelease(state->impulse);
+	free(state->input); free(state->dry); free(state->output); free(state->overlap);
+	free(state->fdlRe); free(state->fdlIm); free(state->accRe); free(state->accIm);
+	free(state->timeRe); free(state->timeIm);
+	free(state);
+}
+
+/* Clear all history, as if the state was newly created */
+void awaveConvolutionReset(AwaveConvolution *state)
+{
+	AwaveImpulse *ir = state->impulse;
+	int blockSize = state->channels * ir->partitionSize * sizeof(float);
+	int delayLineSize = state->channels * ir->partitions * ir->bins * sizeof(float);
+	
+	state->index = 0;
+	state->head = 0;
+	memset(state->input, 0, blockSize);
+	memset(state->dry, 0, blockSize);
+	memset(state->output, 0, blockSize);
+	memset(state->overlap, 0, blockSize);
+	memset(state->fdlRe, 0, delayLineSize);
+	memset(state->fdlIm, 0, delayLineSize);
+}
+
+/**
+ * Convolve one complete input block, filling the output block. Without wet, only the dry delay runs:
+ * the block enters the delay line as silence and the output is silent, which is far cheaper and leaves
+ * the state consistent for wet blocks to follow.
+ */
+static void convolveBlock(AwaveConvolution *state, int wet)
+{
+	AwaveImpulse *ir = state->impulse;
+	int size = ir->partitionSize;
+	int partitions = ir->partitions;
+	int bins = ir->bins;
+	int c, p, k, slot, count4, remainder;
+	float *xr, *xi, *hr, *hi, *ar, *ai, *out, *overlap;
+	float *time = scratch1; // 2 * partitionSize floats
+	float *swap;
+	
+	// The oldest slot in the delay line is overwritten by the newest spectrum
+	state->head = (state->head + partitions - 1) % partitions;
+	
+	for (c = 0; c < state->channels && !wet; c++) {
+		slot = (c * partitions + state->head) * bins;
+		memset(state->fdlRe + slot, 0, bins * sizeof(float));
+		memset(state->fdlIm + slot, 0, bins * sizeof(float));
+		memset(state->output + c * size, 0, size * sizeof(float));
+		memset(state->overlap + c * size, 0, size * sizeof(float));
+	}
+	
+	for (c = 0; c < state->channels && wet; c++) {
+		memcpy(time, state->input + c * size, size * sizeof(float));
+		memset(time + size, 0, size * sizeof(float));
+		slot = (c * partitions + state->head) * bins;
+		realForward(&ir->fft, time, state->fdlRe + slot, state->fdlIm + slot, state->timeRe, state->timeIm);
+		
+		// Multiply-accumulate each delayed input spectrum with its impulse partition
+		memset(state->accRe, 0, bins * sizeof(float));
+		memset(state->accIm, 0, bins * sizeof(float));
+		for (p = 0; p < partitions; p++) {
+			slot = (c * partitions + (state->head + p) % partitions) * bins;
+			xr = state->fdlRe + slot;
+			xi = state->fdlIm + slot;
+			hr = ir->re + ((c % ir->channels) * partitions + p) * bins;
+			hi = ir->im + ((c % ir->channels) * partitions + p) * bins;
+			ar = state->accRe;
+			ai = state->accIm;
+			count4 = bins / 4;
+			remainder = bins % 4;
+			while (count4--) {
+				ar[0] += xr[0]*hr[0] - xi[0]*hi[0]; ai[0] += xr[0]*hi[0] + xi[0]*hr[0];
+				ar[1] += xr[1]*hr[1] - xi[1]*hi[1]; ai[1] += xr[1]*hi[1] + xi[1]*hr[1];
+				ar[2] += xr[2]*hr[2] - xi[2]*hi[2]; ai[2] += xr[2]*hi[2] + xi[2]*hr[2];
+				ar[3] += xr[3]*hr[3] - xi[3]*hi[3]; ai[3] += xr[3]*hi[3] + xi[3]*hr[3];
+				xr += 4; xi += 4; hr += 4; hi += 4; ar += 4; ai += 4;
+			}
+			while (remainder--) {
+				*ar++ += *xr * *hr - *xi * *hi;
+				*ai++ += *xr * *hi + *xi * *hr;
+				xr++; xi++; hr++; hi++;
+			}
+		}
+		
+		// Back to the time domain, then overlap-add with the previous block's tail
+		realInverse(&ir->fft, state->accRe, state->accIm, time, state->timeRe, state->timeIm);
+		out = state->output + c * size;
+		overlap = state->overlap + c * size;
+		for (k = 0; k < size; k++) {
+			out[k] = time[k] + overlap[k];
+			overlap[k] = time[size + k];
+		}
+	}
+	
+	// The block just collected becomes the delayed dry signal
+	swap = state->dry;
+	state->dry = state->input;
+	state->input = swap;
+}
+
+static void convolveFrames(AwaveConvolution *state, float *buffer, int frames, float dryMix, float wetMix, int wet)
+{
+	int size = state->impulse->partitionSize;
+	int channels = state->channels;
+	int c, index;
+	float x;
+	
+	while (frames--) {
+		index = state->index;
+		for (c = 0; c < channels; c++) {
+			x = *buffer;
+			state->input[c * size + index] = x;
+			*buffer++ = state->dry[c * size + index] * dryMix + state->output[c * size + index] * wetMix + 1e-15 - 1e-15;
+		}
+		if (++state->index == size) {
+			convolveBlock(state, wet);
+			state->index = 0;
+		}
+	}
+}
+
+/* Run interleaved frames through the convolution in place */
+void awaveConvolve(AwaveConvolution *state, float *buffer, int frames, float dryMix, float wetMix)
+{
+	convolveFrames(state, buffer, frames, dryMix, wetMix, 1);
+}
+
+/**
+ * Delay interleaved frames in place by the partition size, as awaveConvolve() would with no wet mix,
+ * but without convolving. For a bypassed convolution that must keep the same latency.
+ */
+void awaveConvolveDry(AwaveConvolution *state, float *buffer, int frames, float dryMix)
+{
+	convolveFrames(state, buffer, frames, dryMix, 0, 0);
+}
+
+int awaveConvolutionChannels(AwaveConvolution *convolution)
+{
+	return convolution->channels;
+}
+
+/**
+ * Command buffers
+ *
+ * A command buffer is a run of fixed size records, each describing one operation. The host writes
+ * the records and runs the whole block of them with one call, rather than paying the cost of a call
+ * into the library for every operation. Under Alchemy, AS3 writes them straight into sample memory.
+ * 
+ * Runs count commands in order. Returns the number of commands run, which is less than count
+ * only if an unknown opcode was found.
+ */
+int awaveExecute(AwaveCommand *commands, int count)
+{
+	int i;
+	AwaveCommand *command = commands;
+	float *target, *source;
+	
+	for (i = 0; i < count; i++, command++) {
+		target = command->target;
+		source = (float *) command->source;
+		switch (command->op) {
+			case AWAVE_COMMAND_SET_SAMPLES:
+				awaveSetSamples(target, command->channels, command->frames, command->arg[0]);
+				break;
+			case AWAVE_COMMAND_CHANGE_GAIN:
+				awaveChangeGain(target, command->channels, command->frames, command->arg[0], command->arg[1]);
+				break;
+			case AWAVE_COMMAND_MIX_IN:
+				awaveMixIn(target, source, command->channels, command->frames, command->arg[0], command->arg[1]);
+				break;
+			case AWAVE_COMMAND_MIX_IN_PAN:
+				awaveMixInPan(target, source, command->frames, command->arg[0], command->arg[1]);
+				break;
+			case AWAVE_COMMAND_MULTIPLY_IN:
+				awaveMultiplyIn(target, source, command->channels, command->frames, command->arg[0]);
+				break;
+			case AWAVE_COMMAND_COPY:
+				memcpy(target, source, command->frames * command->channels * sizeof(float));
+				break;
+			case AWAVE_COMMAND_ENVELOPE:
+				awaveEnvelope(target, command->channels, command->frames, 
+					command->arg[0], command->arg[1], command->arg[2], command->arg[3]);
+				break;
+			case AWAVE_COMMAND_WAVETABLE_IN:
+				// The final phase is written back over the initial phase, for AS3 to read
+				command->arg[0] = (float) awaveWavetableIn(target, source, command->channels, command->frames, command->param,
+					command->arg[0], command->arg[1], command->arg[2], command->arg[3], command->arg[4]);
+				break;
+			case AWAVE_COMMAND_BIQUAD_SWEEP:
+				awaveBiquadSweep(target, source, command->channels, command->frames, command->param, (int) command->arg[0],
+					command->arg[1], command->arg[2], command->arg[3], command->arg[4], command->arg[5], command->arg[6]);
+				break;
+			case AWAVE_COMMAND_OVERDRIVE:
+				awaveOverdrive(target, command->channels, command->frames);
+				break;
+			case AWAVE_COMMAND_CLIP:
+				awaveClip(target, command->channels, command->frames);
+				break;
+			case AWAVE_COMMAND_CONVOLVE:
+				if (command->channels == ((AwaveConvolution *) command->source)->channels) {
+					awaveConvolve((AwaveConvolution *) command->source, target, command->frames, command->arg[0], command->arg[1]);
+				}
+				break;
+			case AWAVE_COMMAND_SHAPE:
+				if (command->channels == ((AwaveShaper *) command->source)->channels) {
+					awaveShape((AwaveShaper *) command->source, target, command->frames);
+				}
+				break;
+			default:
+				return i;
+		}
+	}
+	
+	return count;
+}
+
+/**
+ * Folds sample memory into a 32 bit FNV-1a hash, quantizing each value to 16 bits first,
+ * so that renders can be compared against a stored golden hash. Pass the previous result
+ * to hash a sample block by block, starting from AWAVE_CHECKSUM_SEED.
+ */
+unsigned int awaveChecksum(float *buffer, int count, unsigned int hash)
+{
+	int i, q;
+	
+	for (i = 0; i < count; i++) {
+		q = (int) (clampSample(buffer[i], -1.0f, 1.0f) * 32767);
+		hash = (hash ^ (q & 0xff)) * 16777619u;
+		hash = (hash ^ ((q >> 8) & 0xff)) * 16777619u;
+	}
+	return hash;
+}
+
+/* The largest absolute difference between two runs of sample memory */
+float awaveMaxDifference(float *a, float *b, int count)
+{
+	float d, max = 0;
+	int i;
+	
+	for (i = 0; i < count; i++) {
+		d = fabsf(a[i] - b[i]);
+		max = d > max ? d : max;
+	}
+	return max;
+}
+
+/* Converts floats to 16 bit fixed point */
+void awaveFloatToShort(short *out, float *buffer, int count)
+{
+	while (count--)  {
+		*out++ = (short) (*buffer++ * 32768 + 0.5 ); 
+	}
+}
+
+/* Converts 16 bit fixed point to floats, scaled by divisor */
+void awaveShortToFloat(float *buffer, short *in, int count, float divisor)
+{
+	while (count--) {
+		*buffer++ = (float) (*in++ * divisor);
+	}
+}
+
+/**
+ * Rendering engine
+ *
+ * Voices are kept in an array in the order they were added, and each render call mixes
+ * every voice that overlaps the requested block straight into the caller's buffer.
+ * A voice with effects is first copied into the engine's block, where its effects run in order.
+ */
+
+typedef struct {
+	AwaveSample *sample;    // 0 for a generator voice, whose effects fill a silent block
+	int channels;
+	int frames;
+	double onset;
+	float leftGain;
+	float rightGain;
+	AwaveCommand *effects;  // commands run on each block of the voice, targets filled in per block
+	int effectCount;
+} AwaveVoice;
+
+struct AwaveEngine {
+	int channels;
+	int rate;
+	double position;
+	double frameCount;
+	AwaveVoice *voices;
+	int voiceCount;
+	int voiceCapacity;
+	float *block;           // where voices with effects are rendered
+	int blockCapacity;      // in floats
+};
+
+/* Creates an engine with mono or stereo output. Returns 0 for other channel counts, or if memory ran out. */
+AwaveEngine *awaveEngineCreate(int channels, int rate)
+{
+	AwaveEngine *engine;
+	
+	if (channels < 1 || channels > 2 || rate <= 0) {
+		return 0;
+	}
+	engine = (AwaveEngine *) calloc(1, sizeof(AwaveEngine));
+	if (!engine) {
+		return 0;
+	}
+	engine->channels = channels;
+	engine->rate = rate;
+	return engine;
+}
+
+void awaveEngineDestroy(AwaveEngine *engine)
+{
+	awaveEngineClear(engine);
+	free(engine->voices);
+	free(engine->block);
+	free(engine);
+}
+
+static int addVoice(AwaveEngine *engine, AwaveSample *sample, int channels, int frames, 
+	double onset, float leftGain, float rightGain)
+{
+	AwaveVoice *voices;
+	AwaveVoice *voice;
+	int capacity;
+	
+	if (engine->voiceCount == engine->voiceCapacity) {
+		capacity = engine->voiceCapacity ? engine->voiceCapacity * 2 : 64;
+		voices = (AwaveVoice *) realloc(engine->voices, capacity * sizeof(AwaveVoice));
+		if (!voices) {
+			return -1;
+		}
+		engine->voices = voices;
+		engine->voiceCapacity = capacity;
+	}
+	voice = engine->voices + engine->voiceCount;
+	voice->sample = sample;
+	voice->channels = channels;
+	voice->frames = frames;
+	voice->onset = onset;
+	voice->leftGain = leftGain;
+	voice->rightGain = rightGain;
+	voice->effects = 0;
+	voice->effectCount = 0;
+	if (onset + frames > engine->frameCount) {
+		engine->frameCount = onset + frames;
+	}
+	return engine->voiceCount++;
+}
+
+/**
+ * Places a sample in the output at an onset in frames. The sample must have the engine's rate,
+ * and may have either one or two channels. Returns the index of the voice, or -1 on failure.
+ */
+int awaveEngineAddVoice(AwaveEngine *engine, AwaveSample *sample, double onset, float leftGain, float rightGain)
+{
+	if (sample->rate != engine->rate || sample->channels < 1 || sample->channels > 2) {
+		return -1;
+	}
+	return addVoice(engine, sample, sample->channels, sample->frames, onset, leftGain, rightGain);
+}
+
+/**
+ * Places a voice of silence in the output, for its effects to generate into, such as a wavetable.
+ * Returns the index of the voice, or -1 on failure.
+ */
+int awaveEngineAddGenerator(AwaveEngine *engine, int channels, int frames, double onset, float leftGain, float rightGain)
+{
+	if (channels < 1 || channels > 2 || frames < 0) {
+		return -1;
+	}
+	return addVoice(engine, 0, channels, frames, onset, leftGain, rightGain);
+}
+
+/**
+ * Appends a command to a voice's effects, which are run in order on each block of the voice before
+ * it is mixed. The command is copied, with its target, channels and frames filled in for each block.
+ * Its arguments are the same for every block, except a wavetable's phase, which carries on from the last.
+ * The ops that only work on their target are allowed, along with wavetables, biquads, convolutions and
+ * shapers, whose source is their state. Effects keep their state across blocks, so a voice is meant to
+ * be rendered in order, and the host resets that state after moving the position if it needs to.
+ * Returns the index of the effect, or -1 if the op is not allowed or memory ran out.
+ */
+int awaveEngineAddEffect(AwaveEngine *engine, int voiceIndex, AwaveCommand *effect)
+{
+	AwaveVoice *voice;
+	AwaveCommand *effects;
+	
+	if (voiceIndex < 0 || voiceIndex >= engine->voiceCount) {
+		return -1;
+	}
+	voice = engine->voices + voiceIndex;
+	switch (effect->op) {
+		case AWAVE_COMMAND_SET_SAMPLES:
+		case AWAVE_COMMAND_CHANGE_GAIN:
+		case AWAVE_COMMAND_ENVELOPE:
+		case AWAVE_COMMAND_OVERDRIVE:
+		case AWAVE_COMMAND_CLIP:
+			break;
+		case AWAVE_COMMAND_WAVETABLE_IN:
+		case AWAVE_COMMAND_BIQUAD_SWEEP:
+			if (!effect->source) {
+				return -1;
+			}
+			break;
+		case AWAVE_COMMAND_CONVOLVE:
+			if (!effect->source || ((AwaveConvolution *) effect->source)->channels != voice->channels) {
+				return -1;
+			}
+			break;
+		case AWAVE_COMMAND_SHAPE:
+			if (!effect->source || ((AwaveShaper *) effect->source)->channels != voice->channels) {
+				return -1;
+			}
+			break;
+		default:
+			// Ops reading other sample memory have no place in a block rendered by the engine
+			return -1;
+	}
+	effects = (AwaveCommand *) realloc(voice->effects, (voice->effectCount + 1) * sizeof(AwaveCommand));
+	if (!effects) {
+		return -1;
+	}
+	voice->effects = effects;
+	voice->effects[voice->effectCount] = *effect;
+	return voice->effectCount++;
+}
+
+/* Removes all voices and rewinds */
+void awaveEngineClear(AwaveEngine *engine)
+{
+	int v;
+	
+	for (v = 0; v < engine->voiceCount; v++) {
+		free(engine->voices[v].effects);
+	}
+	engine->voiceCount = 0;
+	engine->frameCount = 0;
+	engine->position = 0;
+}
+
+/* The frame at which the last voice ends */
+double awaveEngineFrameCount(AwaveEngine *engine)
+{
+	return engine->frameCount;
+}
+
+double awaveEngineGetPosition(AwaveEngine *engine)
+{
+	return engine->position;
+}
+
+void awaveEngineSetPosition(AwaveEngine *engine, double position)
+{
+	engine->position = position;
+}
+
+/* Fills the engine's block with count frames of a voice from sourceOffset, through its effects */
+static float *renderVoiceBlock(AwaveEngine *engine, AwaveVoice *voice, int sourceOffset, int count)
+{
+	AwaveCommand *effect;
+	int e;
+	
+	if (voice->sample) {
+		memcpy(engine->block, voice->sample->data + sourceOffset * voice->channels, count * voice->channels * sizeof(float));
+	} else {
+		awaveSetSamples(engine->block, voice->channels, count, 0);
+	}
+	for (e = 0; e < voice->effectCount; e++) {
+		effect = voice->effects + e;
+		effect->target = engine->block;
+		effect->channels = voice->channels;
+		effect->frames = count;
+		awaveExecute(effect, 1);
+	}
+	return engine->block;
+}
+
+/**
+ * Renders the next block of frames into out, which must hold frames * channels floats,
+ * and advances the position. Returns the number of frames that lie before the end of the last voice,
+ * so a return value less than frames means the performance has finished. Returns -1, rendering
+ * nothing, if there was no memory to run the voices' effects in.
+ */
+int awaveEngineRender(AwaveEngine *engine, float *out, int frames)
+{
+	double blockStart = engine->position;
+	double blockEnd = blockStart + frames;
+	AwaveVoice *voice;
+	float *source, *target, *block;
+	int v, offset, sourceOffset, count, i;
+	double remaining;
+	
+	if (frames * 2 > engine->blockCapacity) {
+		block = (float *) realloc(engine->block, frames * 2 * sizeof(float));
+		if (!block) {
+			return -1;
+		}
+		engine->block = block;
+		engine->blockCapacity = frames * 2;
+	}
+	
+	awaveSetSamples(out, engine->channels, frames, 0);
+	
+	for (v = 0; v < engine->voiceCount; v++) {
+		voice = engine->voices + v;
+		if (voice->onset >= blockEnd || voice->onset + voice->frames <= blockStart) {
+			continue;
+		}
+		
+		// Find the overlap of this voice with the block
+		if (voice->onset > blockStart) {
+			offset = (int) (voice->onset - blockStart);
+			sourceOffset = 0;
+		} else {
+			offset = 0;
+			sourceOffset = (int) (blockStart - voice->onset);
+		}
+		count = frames - offset;
+		if (count > voice->frames - sourceOffset) {
+			count = voice->frames - sourceOffset;
+		}
+		if (count <= 0) {
+			continue;
+		}
+		
+		if (voice->sample && !voice->effectCount) {
+			source = voice->sample->data + sourceOffset * voice->channels;
+		} else {
+			source = renderVoiceBlock(engine, voice, sourceOffset, count);
+		}
+		target = out + offset * engine->channels;
+		if (voice->channels == engine->channels) {
+			awaveMixIn(target, source, engine->channels, count, voice->leftGain, voice->rightGain);
+		} else if (engine->channels == 2) {
+			awaveMixInPan(target, source, count, voice->leftGain, voice->rightGain);
+		} else {
+			// Fold a stereo voice down into mono output
+			for (i = 0; i < count; i++) {
+				target[i] += (source[2*i] * voice->leftGain + source[2*i+1] * voice->rightGain) * 0.5f;
+			}
+		}
+	}
+	
+	engine->position = blockEnd;
+	remaining = engine->frameCount - blockStart;
+	if (remaining < 0) {
+		return 0;
+	}
+	return (remaining < frames) ? (int) remaining : frames;
+}
+
+static int fillNoteLookupTable()
+{
+	int b;
+	float n = 0.0;
+	
+	for (b=0; b<8192; b++) {
+		// Concert A = Note 69 = 440Hz. DEAL
+		noteToFreqLookup[b] = (float)(440 * pow(2.0, (n-69)/12));
+		n += 0.015625; // 1/64
+	}
+	return 0;
+}
+
+static int fillPowerLookupTable()
+{
+	int b;
+	float ln10div20 = 2.3025850929940459011 / 20;
+	float db = -128.0;
+	for (b=0; b<8192; b++) {
+		// From -128db to +128db in 1/32 db steps
+		dbToPowerLookup[b] = exp(db * ln10div20);
+		db += .03125; // 1/32
+	}
+	return 0;
+}
+
+/* Blackman windowed sinc, normalized so that the odd taps sum to 0.5 for unity gain */
+static int fillHalfbandTable()
+{
+	int i, n;
+	double pi = 3.1415926535897932384626433832795029;
+	double w, sum = 0;
+	
+	for (i = 0; i < HALFBAND_TAPS; i++) {
+		// Odd offsets from the center of a filter 2*HALFBAND_TAPS - 1 long
+		n = 2*i - (HALFBAND_TAPS - 1);
+		w = 0.42 + 0.5 * cos(pi * n / HALFBAND_TAPS) + 0.08 * cos(2 * pi * n / HALFBAND_TAPS);
+		halfbandTable[i] = (float) (sin(pi * n / 2) / (pi * n) * w);
+		sum += halfbandTable[i];
+	}
+	for (i = 0; i < HALFBAND_TAPS; i++) {
+		halfbandTable[i] = (float) (halfbandTable[i] * 0.5 / sum);
+	}
+	return 0;
+}
+
+static int fillSineTable()
+{
+	int i;
+	double pi = 3.1415926535897932384626433832795029;
+	
+	for (i = 0; i <= SINE_TABLE_SIZE; i++) {
+		sineTable[i] = (float) sin(2 * pi * i / SINE_TABLE_SIZE);
+	}
+	return 0;
+}
+
+void awaveInit(void)
+{
+	fillNoteLookupTable();
+	fillPowerLookupTable();
+	fillHalfbandTable();
+	fillSineTable();
+}
@@ -0,0 +1,284 @@
+/*
+ *  libawave.h
+ *  Part of Standing Wave 3
+ *  Plain C audio rendering library
+ *
+ *  maxlord@gmail.com
+ *
+ */
+
+/**
+ * libawave holds all of the DSP routines of Standing Wave, with no dependency on Flash.
+ * awave.c is a thin Alchemy adapter that exposes these routines to AS3, and the same code may be
+ * built as an ordinary C library to render audio on a server.
+ *
+ * Sample memory is 32 bit float, with stereo channels interleaved. Most routines operate directly on
+ * float pointers into sample memory, so a host can pass offset pointers to work on a slice of a sample.
+ * Memory may instead be planar, with each channel in its own plane; run the kernels on each plane as mono.
+ * Call awaveInit() once before using anything else.
+ */
+
+#ifndef LIBAWAVE_H
+#define LIBAWAVE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Biquad filter types, matching the type constants in BiquadFilter.as */
+#define AWAVE_BIQUAD_LOW_PASS 0
+#define AWAVE_BIQUAD_HIGH_PASS 1
+#define AWAVE_BIQUAD_BAND_PASS 2
+#define AWAVE_BIQUAD_PEAK 3
+#define AWAVE_BIQUAD_LOW_SHELF 4
+#define AWAVE_BIQUAD_HIGH_SHELF 5
+
+/* Command opcodes, matching the constants in CommandBuffer.as */
+#define AWAVE_COMMAND_SET_SAMPLES 1
+#define AWAVE_COMMAND_CHANGE_GAIN 2
+#define AWAVE_COMMAND_MIX_IN 3
+#define AWAVE_COMMAND_MIX_IN_PAN 4
+#define AWAVE_COMMAND_MULTIPLY_IN 5
+#define AWAVE_COMMAND_COPY 6
+#define AWAVE_COMMAND_ENVELOPE 7
+#define AWAVE_COMMAND_WAVETABLE_IN 8
+#define AWAVE_COMMAND_BIQUAD_SWEEP 9
+#define AWAVE_COMMAND_OVERDRIVE 10
+#define AWAVE_COMMAND_CLIP 11
+#define AWAVE_COMMAND_CONVOLVE 12
+#define AWAVE_COMMAND_SHAPE 13
+
+/* Gain ramp curves, matching the RAMP_ constants in Sample.as */
+#define AWAVE_RAMP_LINEAR 0
+#define AWAVE_RAMP_EXPONENTIAL 1
+
+/* Waveshaping curves, matching the curve constants in OverdriveFilter.as */
+#define AWAVE_SHAPE_OVERDRIVE 0
+#define AWAVE_SHAPE_CLIP 1
+
+/* The largest convolution partition, whose transform must fit in the scratch memory */
+#define AWAVE_MAX_PARTITION 8192
+
+/**
+ * One queued operation. AS3 writes these as 64 byte records, which relies on
+ * pointers being 32 bits wide as they are under Alchemy.
+ */
+typedef struct {
+	int op;          // one of the AWAVE_COMMAND_ constants
+	float *target;   // sample memory operated on
+	void *source;    // source sample memory, wavetable, biquad state, or convolution
+	int channels;
+	int frames;
+	int param;       // integer parameter, depending on op
+	float arg[10];   // float parameters, depending on op
+} AwaveCommand;
+
+/* Modulation curve types, matching the constants in AbstractModulationData.as */
+#define AWAVE_CURVE_LINE 0
+#define AWAVE_CURVE_SPLINE 1
+
+/* Sample bank magic ("SWBK" as a little endian int), version, and zone formats, matching SampleBank.as */
+#define AWAVE_BANK_MAGIC 0x4b425753
+#define AWAVE_BANK_VERSION 1
+#define AWAVE_BANK_FLOAT 0
+#define AWAVE_BANK_SHORT 1
+
+/**
+ * One entry of a sample bank's zone table, 64 bytes as written by SampleBank.as.
+ */
+typedef struct {
+	char name[16];     // null padded
+	int rate;
+	int channels;
+	int frames;
+	int format;        // AWAVE_BANK_FLOAT or AWAVE_BANK_SHORT
+	int startFrame;    // loop start and end, both 0 if the zone does not loop
+	int endFrame;
+	int firstFrame;    // where playback begins
+	int rootNote;      // the MIDI note recorded, and the notes the zone plays
+	int lowNote;
+	int highNote;
+	int offset;        // bytes from the start of the bank, a multiple of 16
+	int bytes;
+} AwaveBankZone;
+
+/* Oscillator waveforms, matching the constants in OscillatorSource.as */
+#define AWAVE_WAVE_SINE 0
+#define AWAVE_WAVE_SAW 1
+#define AWAVE_WAVE_SQUARE 2
+#define AWAVE_WAVE_TRIANGLE 3
+
+/* Noise colors, matching the constants in NoiseSource.as, and the floats of noise state per channel */
+#define AWAVE_NOISE_WHITE 0
+#define AWAVE_NOISE_PINK 1
+#define AWAVE_NOISE_STATE 8
+
+/* The starting value for awaveChecksum() */
+#define AWAVE_CHECKSUM_SEED 2166136261u
+
+/* Render quality, matching the constants in RenderQuality.as */
+#define AWAVE_QUALITY_FULL 0
+#define AWAVE_QUALITY_DRAFT 1
+
+/* Owner categories for sample memory accounting, matching the constants in Sample.as */
+#define AWAVE_MEMORY_ALL -1
+#define AWAVE_MEMORY_TRANSIENT 0
+#define AWAVE_MEMORY_CACHE 1
+#define AWAVE_MEMORY_POOL 2
+#define AWAVE_MEMORY_SCRATCH 3
+#define AWAVE_MEMORY_CATEGORIES 4
+
+/* Opaque handles */
+typedef struct AwaveSample AwaveSample;
+typedef struct AwaveImpulse AwaveImpulse;
+typedef struct AwaveConvolution AwaveConvolution;
+typedef struct AwaveShaper AwaveShaper;
+typedef struct AwaveEngine AwaveEngine;
+typedef struct AwaveCurve AwaveCurve;
+
+/* Fills the lookup tables. Call once before anything else. */
+void awaveInit(void);
+
+/**
+ * Raw sample memory
+ * Sample memory must be freed with awaveFreeSampleMemory(), as every block carries a hidden header
+ * used to account for it. Allocation returns 0 when it would exceed the memory budget.
+ */
+float *awaveAllocateSampleMemory(int frames, int channels, int zero);
+float *awaveReallocateSampleMemory(float *buffer, int oldFrames, int newFrames, int channels);
+void awaveFreeSampleMemory(float *buffer);
+
+/* Sample memory accounting */
+void awaveSetMemoryCategory(float *buffer, int category);
+int awaveMemoryCategory(float *buffer);
+int awaveMemoryUsage(int category);
+void awaveSetMemoryBudget(int bytes);
+int awaveMemoryBudget(void);
+
+/* Planar sample memory, with each channel in a contiguous plane of planeStride frames */
+float *awaveReallocatePlanes(float *buffer, int oldFrames, int newFrames, int channels);
+void awaveInterleave(float *buffer, float *planes, int channels, int frames, int planeStride);
+void awaveDeinterleave(float *planes, float *buffer, int channels, int frames, int planeStride);
+
+/* Single channels of interleaved memory, to and from a contiguous buffer */
+void awaveExtractChannel(float *out, float *buffer, int channels, int channel, int frames);
+void awaveInsertChannel(float *buffer, float *in, int channels, int channel, int frames);
+
+/* Sample handles, which carry their own format */
+AwaveSample *awaveSampleCreate(int channels, int frames, int rate);
+AwaveSample *awaveSampleWrap(float *data, int channels, int frames, int rate);
+void awaveSampleDestroy(AwaveSample *sample);
+float *awaveSampleData(AwaveSample *sample);
+int awaveSampleChannels(AwaveSample *sample);
+int awaveSampleFrames(AwaveSample *sample);
+int awaveSampleRate(AwaveSample *sample);
+
+/* Engine-wide render quality, which selects cheaper methods in some kernels */
+void awaveSetQuality(int quality);
+int awaveQuality(void);
+
+/* Kernels on sample memory */
+void awaveSetSamples(float *buffer, int channels, int frames, float value);
+void awaveCopy(float *buffer, float *sourceBuffer, int channels, int frames);
+void awaveStandardize(float *buffer, float *sourceBuffer, int channels, int frames, int rate);
+void awaveChangeGain(float *buffer, int channels, int frames, float leftGain, float rightGain);
+void awaveMixIn(float *buffer, float *sourceBuffer, int channels, int frames, float leftGain, float rightGain);
+void awaveMixInPan(float *buffer, float *sourceBuffer, int frames, float leftGain, float rightGain);
+void awaveMixInRamp(float *buffer, float *sourceBuffer, int channels, int frames,
+	float leftStart, float leftEnd, float rightStart, float rightEnd, int curve);
+void awaveMixInPanRamp(float *buffer, float *sourceBuffer, int frames,
+	float leftStart, float leftEnd, float rightStart, float rightEnd, int curve);
+void awaveMultiplyIn(float *buffer, float *sourceBuffer, int channels, int frames, float gain);
+double awaveWavetableIn(float *buffer, float *sourceBuffer, int channels, int frames, int tableSize,
+	double phase, float phaseAdd, float phaseReset, float y1, float y2);
+double awaveWavetableInMod(float *buffer, float *sourceBuffer, int channels, int frames, int tableSize,
+	double phase, float phaseAdd, float phaseReset, float *shift);
+double awaveOscillator(float *buffer, int channels, int frames, int wave, double phase, double phaseAdd, float amplitude);
+void awaveNoise(float *buffer, float *stateBuffer, int channels, int frames, int color, float amplitude);
+void awaveEnvelope(float *buffer, int channels, int frames, float y0, float y1, float y2, float y3);
+void awaveDelay(float *buffer, float *ringBuffer, int channels, int frames, int length, float dryMix, float wetMix, float feedback);
+void awaveBiquad(float *buffer, float *stateBuffer, int channels, int frames, float b0, float b1, float b2, float a1, float a2);
+void awaveBiquadCoefficients(int type, float freq, float q, float dbGain, float rate, float *coeffs);
+void awaveBiquadSweep(float *buffer, float *stateBuffer, int channels, int frames, int type, int rate,
+	float startFreq, float endFreq, float startQ, float endQ, float startGain, float endGain);
+void awaveOverdrive(float *buffer, int channels, int frames);
+void awaveClip(float *buffer, int channels, int frames);
+void awaveNormalize(float *buffer, int channels, int frames, float desiredMaxAmp);
+unsigned int awaveChecksum(float *buffer, int count, unsigned int hash);
+float awaveMaxDifference(float *a, float *b, int count);
+void awaveFloatToShort(short *out, float *buffer, int count);
+void awaveShortToFloat(float *buffer, short *in, int count, float divisor);
+
+/* Oversampled waveshaping */
+AwaveShaper *awaveShaperCreate(int curve, int channels, int oversample);
+void awaveShaperDestroy(AwaveShaper *shaper);
+void awaveShaperReset(AwaveShaper *shaper);
+int awaveShaperChannels(AwaveShaper *shaper);
+float awaveShaperLatency(AwaveShaper *shaper);
+void awaveShape(AwaveShaper *shaper, float *buffer, int frames);
+
+/* Partitioned convolution. Partition sizes are powers of two, from 2 to AWAVE_MAX_PARTITION. */
+AwaveImpulse *awaveImpulseCreate(float *impulse, int channels, int frames, int partitionSize);
+void awaveImpulseRelease(AwaveImpulse *impulse);
+AwaveConvolution *awaveConvolutionCreate(AwaveImpulse *impulse, int channels);
+void awaveConvolutionDestroy(AwaveConvolution *convolution);
+void awaveConvolutionReset(AwaveConvolution *convolution);
+int awaveConvolutionChannels(AwaveConvolution *convolution);
+void awaveConvolve(AwaveConvolution *convolution, float *buffer, int frames, float dryMix, float wetMix);
+void awaveConvolveDry(AwaveConvolution *convolution, float *buffer, int frames, float dryMix);
+
+/**
+ * Modulation curves
+ * Keyframes are kept sorted by position. Voices evaluate a curve through their own cursor,
+ * an int starting at 0 that each render call returns advanced.
+ * A null curve may be read, and is 0 everywhere.
+ */
+AwaveCurve *awaveCurveCreate(int type);
+void awaveCurveDestroy(AwaveCurve *curve);
+void awaveCurveClear(AwaveCurve *curve);
+int awaveCurveCount(AwaveCurve *curve);
+int awaveCurveAdd(AwaveCurve *curve, double position, float value);
+float awaveCurveValue(AwaveCurve *curve, double position);
+int awaveCurveRender(AwaveCurve *curve, int cursor, double position, float *out, int frames);
+double awaveWavetableInCurve(float *buffer, float *sourceBuffer, int channels, int frames, int tableSize,
+	double phase, float phaseAdd, float phaseReset, AwaveCurve *curve, int *cursor, double position);
+
+/**
+ * Sample banks
+ * A bank packs pre-standardized zones with their loop points into one little endian block, with each
+ * zone's data aligned to 16 bytes. The routines work in place, so a host may map a bank file read only
+ * and share it between processes, passing float zones straight to the kernels as sample memory.
+ * Check a bank once with awaveBankCheck() before using the other routines on it.
+ */
+int awaveBankCheck(void *bank, int bytes);
+AwaveBankZone *awaveBankZone(void *bank, int index);
+void *awaveBankZoneData(void *bank, AwaveBankZone *zone);
+void awaveBankDecode(float *buffer, void *bank, AwaveBankZone *zone);
+
+/* Command buffers. Returns the number of commands run. */
+int awaveExecute(AwaveCommand *commands, int count);
+
+/**
+ * Rendering engine
+ * An engine mixes a list of voices placed at onsets into an output stream, which the host pulls
+ * a block at a time with awaveEngineRender(). A voice plays a sample, or generates its signal, and
+ * runs it through a chain of effects given as commands, so whole filtered voices render natively.
+ * Voices without effects are mixed straight from their samples into the caller's buffer.
+ * Samples and effect states are not owned by the engine, and must outlive it.
+ */
+AwaveEngine *awaveEngineCreate(int channels, int rate);
+void awaveEngineDestroy(AwaveEngine *engine);
+int awaveEngineAddVoice(AwaveEngine *engine, AwaveSample *sample, double onset, float leftGain, float rightGain);
+int awaveEngineAddGenerator(AwaveEngine *engine, int channels, int frames, double onset, float leftGain, float rightGain);
+int awaveEngineAddEffect(AwaveEngine *engine, int voice, AwaveCommand *effect);
+void awaveEngineClear(AwaveEngine *engine);
+double awaveEngineFrameCount(AwaveEngine *engine);
+double awaveEngineGetPosition(AwaveEngine *engine);
+void awaveEngineSetPosition(AwaveEngine *engine, double position);
+int awaveEngineRender(AwaveEngine *engine, float *out, int frames);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,49 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  NOTEFLIGHT LLC
+//  Copyright 2009 Noteflight LLC
+// 
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+package com.noteflight.standingwave3.benchmark
+{
+    import com.noteflight.standingwave3.elements.*;
+    import com.noteflight.standingwave3.performance.IPerformance;
+    
+    /**
+     * A BenchmarkScene is a performance to render for a fixed duration, under a name that its
+     * results and golden hashes are filed under. Scenes hold source state, so build a fresh one for every run.
+     */
+    public class BenchmarkScene
+    {
+        public var name:String;
+        public var performance:IPerformance;
+        public var descriptor:AudioDescriptor;
+        
+        /** The number of seconds of the performance to render */
+        public var duration:Number;
+        
+        public function BenchmarkScene(name:String, performance:IPerformance, duration:Number, descriptor:AudioDescriptor = null)
+        {
+            this.name = name;
+            this.performance = performance;
+            this.duration = duration;
+            this.descriptor = descriptor ? descriptor : new AudioDescriptor();
+        }
+        
+        /** The number of frames rendered */
+        public function get frameCount():Number
+        {
+            return Math.floor(duration * descriptor.rate);
+        }
+    }
+}
@@ -0,0 +1,166 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  NOTEFLIGHT LLC
+//  Copyright 2009 Noteflight LLC
+// 
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+package com.noteflight.standingwave3.benchmark
+{
+    import com.noteflight.standingwave3.elements.*;
+    import com.noteflight.standingwave3.filters.*;
+    import com.noteflight.standingwave3.performance.ListPerformance;
+    import com.noteflight.standingwave3.sources.*;
+    
+    /**
+     * Deterministic reference scenes covering the main rendering paths. Every source is synthesized,
+     * and noise restarts from the same seed, so each scene renders identically on every run
+     * and its output hash can be checked against a golden recorded from a known good build.
+     * Each function builds a fresh scene.
+     */
+    public class BenchmarkScenes
+    {
+        /** Every scene, freshly built */
+        public static function all():Array
+        {
+            return [ denseSampler(), longEcho(), filterSweeps(), resampledLoops(), bigList() ];
+        }
+        
+        /**
+         * 400 overlapping sampler voices over a cached sawtooth recording, at about 80 voices of polyphony.
+         */
+        public static function denseSampler():BenchmarkScene
+        {
+            var ad:AudioDescriptor = new AudioDescriptor();
+            var recording:CacheFilter = recordingOf(new OscillatorSource(ad, 2, 220, OscillatorSource.SAW, 0.5));
+            var p:ListPerformance = new ListPerformance();
+            for (var i:int = 0; i < 400; i++) {
+                var voice:SamplerSource = new SamplerSource(ad, recording);
+                voice.frequencyShift = Math.pow(2, ((i * 7) % 24 - 12) / 12);
+                p.addSourceAt(i * 0.025, voice, -18, ((i % 9) - 4) / 4);
+            }
+            return new BenchmarkScene("denseSampler", p, 10, ad);
+        }
+        
+        /**
+         * Square wave phrases through long, heavily fed back echoes.
+         */
+        public static function longEcho():BenchmarkScene
+        {
+            var ad:AudioDescriptor = new AudioDescriptor();
+            var p:ListPerformance = new ListPerformance();
+            for (var i:int = 0; i < 8; i++) {
+                var tone:OscillatorSource = new OscillatorSource(ad, 12, 110 * (i + 2), OscillatorSource.SQUARE, 0.2);
+                p.addSourceAt(i * 1.5, new EchoFilter(tone, 0.25 + i * 0.125, 0.5, 0.8), -6, (i % 2) ? 0.5 : -0.5);
+            }
+            return new BenchmarkScene("longEcho", p, 20, ad);
+        }
+        
+        /**
+         * Saw waves and pink noise through biquad filters sweeping over several octaves.
+         */
+        public static function filterSweeps():BenchmarkScene
+        {
+            var ad:AudioDescriptor = new AudioDescriptor();
+            var p:ListPerformance = new ListPerformance();
+            for (var i:int = 0; i < 12; i++) {
+                var source:IAudioSource = (i % 3 == 2)
+                    ? new NoiseSource(ad, 4, 0.5, NoiseSource.PINK, i + 1)
+                    : new OscillatorSource(ad, 4, 55 * (i + 1), OscillatorSource.SAW, 0.5);
+                var up:Boolean = (i % 2) == 0;
+                p.addSourceAt(i * 0.75, new SweptFilter(source, i % 3, up ? 100 : 8000, up ? 8000 : 100, 4), -6);
+            }
+            return new BenchmarkScene("filterSweeps", p, 12, ad);
+        }
+        
+        /**
+         * Looped recordings through resampling filters at various speeds.
+         */
+        public static function resampledLoops():BenchmarkScene
+        {
+            var ad:AudioDescriptor = new AudioDescriptor();
+            var recording:CacheFilter = recordingOf(new OscillatorSource(ad, 1, 330, OscillatorSource.TRIANGLE, 0.5));
+            var p:ListPerformance = new ListPerformance();
+            for (var i:int = 0; i < 16; i++) {
+                var loop:LoopSource = new LoopSource(ad, recording);
+                loop.startFrame = 4410;
+                loop.endFrame = 44100 - 4410;
+                loop.frequencyShift = 1 + i * 0.05;
+                p.addSourceAt(i * 0.5, new ResamplingFilter(loop, 0.5 + (i % 4) * 0.25), -12, ((i % 5) - 2) / 2);
+            }
+            return new BenchmarkScene("resampledLoops", p, 10, ad);
+        }
+        
+        /**
+         * A ListPerformance of 4000 short notes, exercising element lookup and voice startup.
+         */
+        public static function bigList():BenchmarkScene
+        {
+            var ad:AudioDescriptor = new AudioDescriptor();
+            var p:ListPerformance = new ListPerformance();
+            for (var i:int = 0; i < 4000; i++) {
+                var note:OscillatorSource = new OscillatorSource(ad, 0.1 + (i % 5) * 0.05, 
+                    220 * Math.pow(2, (i % 36) / 12), i % 4, 0.25);
+                p.addSourceAt(i * 0.005, note, -12, ((i % 7) - 3) / 3);
+            }
+            return new BenchmarkScene("bigList", p, 20, ad);
+        }
+        
+        private static function recordingOf(source:IAudioSource):CacheFilter
+        {
+            var recording:CacheFilter = new CacheFilter(source);
+            recording.evictable = false;
+            recording.fill();
+            return recording;
+        }
+    }
+}
+
+import com.noteflight.standingwave3.elements.*;
+import com.noteflight.standingwave3.filters.BiquadFilter;
+
+/**
+ * A BiquadFilter whose frequency sweeps exponentially over a fixed time.
+ */
+class SweptFilter extends BiquadFilter
+{
+    private var _from:Number;
+    private var _to:Number;
+    private var _sweepFrames:Number;
+    private var _frames:Number = 0;
+    
+    public function SweptFilter(source:IAudioSource, type:int, from:Number, to:Number, seconds:Number)
+    {
+        super(source, type, from, 2);
+        _from = from;
+        _to = to;
+        _sweepFrames = seconds * source.descriptor.rate;
+    }
+    
+    override public function resetPosition():void
+    {
+        super.resetPosition();
+        _frames = 0;
+        if (!isNaN(_from)) {
+            // Not while the superclass constructor is still running
+            frequency = _from;
+            settle();
+        }
+    }
+    
+    override public function getSample(numFrames:Number):Sample
+    {
+        _frames += numFrames;
+        frequency = _from * Math.pow(_to / _from, Math.min(1, _frames / _sweepFrames));
+        return super.getSample(numFrames);
+    }
+}
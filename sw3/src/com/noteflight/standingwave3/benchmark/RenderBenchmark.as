@@ -0,0 +1,219 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  NOTEFLIGHT LLC
+//  Copyright 2009 Noteflight LLC
+// 
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+package com.noteflight.standingwave3.benchmark
+{
+    import com.noteflight.standingwave3.elements.*;
+    import com.noteflight.standingwave3.output.AudioSampleHandler;
+    import com.noteflight.standingwave3.performance.AudioPerformer;
+    import com.noteflight.standingwave3.performance.SegmentedBounce;
+    
+    import flash.utils.getTimer;
+    
+    /**
+     * RenderBenchmark renders BenchmarkScenes through the full AudioPerformer path, a block at a time
+     * as an AudioPlayer would, and measures each one. It records the real time factor, per block render
+     * times, peak sample memory, and an output hash.
+     * 
+     * No golden hashes ship with the library, since they depend on the awave build and the player that
+     * renders them. To check output, record hashesOf() the results of a build known to sound right, and
+     * pass them in goldenHashes to later runs, which list mismatches in failures and any scene without
+     * a golden in unchecked. Where bit-exact output is not expected, keep the output, save it as a golden
+     * WAV, and use RenderResult.matchesGolden() with a tolerance.
+     * checkSegmentedBounce() needs no goldens: it checks that a segmented export matches a bounce().
+     * checkBlockAdaptation() checks that an adaptive AudioSampleHandler grows its block size under load
+     * and shrinks it again once the load falls.
+     * 
+     * Rendering happens synchronously, so run benchmarks where a long stall of the Flash player is acceptable.
+     */
+    public class RenderBenchmark
+    {
+        /** Frames per block, matching the output buffer size of the player being modeled */
+        public var blockSize:int = 4096;
+        
+        /** Whether to keep the whole render in each result, for comparison against golden renders */
+        public var keepOutput:Boolean = false;
+        
+        /** Whether the performer reuses its blocks. See AudioPerformer.reuseBuffers. */
+        public var reuseBuffers:Boolean = false;
+        
+        /** Hashes by scene name, recorded by the caller with hashesOf(), and checked by runAll() when present */
+        public var goldenHashes:Object = {};
+        
+        /** Names of the scenes whose hash did not match its golden in the last runAll() */
+        public var failures:Array = [];
+        
+        /** Names of the scenes that had no golden to check in the last runAll() */
+        public var unchecked:Array = [];
+        
+        /**
+         * Render one scene and measure it.
+         */
+        public function run(scene:BenchmarkScene):RenderResult
+        {
+            var result:RenderResult = new RenderResult(scene.name);
+            var performer:AudioPerformer = new AudioPerformer(scene.performance, scene.descriptor);
+            performer.reuseBuffers = reuseBuffers;
+            var total:Number = scene.frameCount;
+            if (keepOutput) {
+                result.output = new Sample(scene.descriptor, total);
+            }
+            result.peakMemory = Sample.getMemoryUsage();
+            
+            while (result.frames < total) {
+                var frames:Number = Math.min(blockSize, total - result.frames);
+                var start:int = getTimer();
+                var block:Sample = performer.getSample(frames);
+                var elapsed:int = getTimer() - start;
+                
+                result.blockTimes.push(elapsed);
+                result.renderTime += elapsed;
+                result.peakMemory = Math.max(result.peakMemory, Sample.getMemoryUsage());
+                if (performer.blockAllocations > 0) {
+                    result.allocations += performer.blockAllocations;
+                    result.lastAllocatingBlock = result.blockTimes.length - 1;
+                }
+                result.hash = block.checksum(result.hash);
+                if (keepOutput) {
+                    result.output.mixIn(block, 1.0, result.frames);
+                }
+                if (!reuseBuffers) {
+                    block.destroy();
+                }
+                result.frames += frames;
+            }
+            result.duration = result.frames / scene.descriptor.rate;
+            performer.releaseBuffers();
+            return result;
+        }
+        
+        /**
+         * Render a list of scenes, by default every scene in BenchmarkScenes, checking each against
+         * its golden hash if there is one. Mismatches are listed in failures, and scenes that could
+         * not be checked in unchecked.
+         * @return an Array of RenderResults
+         */
+        public function runAll(scenes:Array = null):Array
+        {
+            if (!scenes) {
+                scenes = BenchmarkScenes.all();
+            }
+            failures = [];
+            unchecked = [];
+            var results:Array = [];
+            for each (var scene:BenchmarkScene in scenes) {
+                var result:RenderResult = run(scene);
+                if (goldenHashes[scene.name] == undefined) {
+                    unchecked.push(scene.name);
+                } else if (!result.matchesHash(goldenHashes[scene.name])) {
+                    failures.push(scene.name);
+                }
+                results.push(result);
+            }
+            return results;
+        }
+        
+        /**
+         * Check that a SegmentedBounce renders each scene exactly as AudioPerformer.bounce() does.
+         * Scenes hold source state, so each is bounced once whole and once, from a second build of
+         * the same scenes, in segments. Each mismatch is added to failures as the scene name
+         * followed by " (segmented)".
+         * @param scenes the scenes to bounce whole, by default every scene in BenchmarkScenes
+         * @param twins fresh builds of the same scenes to bounce in segments
+         * @param segmentFrames the segment length, short by default so that scenes cross many segments
+         * @return the largest difference between the two renders of each scene, which should be 0
+         */
+        public function checkSegmentedBounce(scenes:Array = null, twins:Array = null,
+            segmentFrames:Number = 4 * AudioPerformer.BOUNCE_FRAMES):Array
+        {
+            if (!scenes) {
+                scenes = BenchmarkScenes.all();
+                twins = BenchmarkScenes.all();
+            }
+            var differences:Array = [];
+            for (var i:int = 0; i < scenes.length; i++) {
+                var scene:BenchmarkScene = scenes[i];
+                var twin:BenchmarkScene = twins[i];
+                
+                var whole:AudioPerformer = new AudioPerformer(scene.performance, scene.descriptor);
+                whole.frameCount = scene.frameCount;
+                var bounced:Sample = whole.bounce();
+                
+                var performer:AudioPerformer = new AudioPerformer(twin.performance, twin.descriptor);
+                performer.frameCount = twin.frameCount;
+                var segments:SegmentedBounce = new SegmentedBounce(performer, segmentFrames);
+                while (!segments.step()) {
+                }
+                
+                var difference:Number = Sample.maxDifference(bounced, segments.result);
+                if (difference != 0) {
+                    failures.push(scene.name + " (segmented)");
+                }
+                differences.push(difference);
+                // Neither performer is used again
+                segments.result.destroy();
+                bounced.destroy();
+            }
+            return differences;
+        }
+        
+        /**
+         * Drive an adaptive AudioSampleHandler with modeled render times: heavy blocks until it reaches
+         * its largest block size, then light ones until it should be back to its smallest. If either
+         * doesn't happen, "block adaptation" is added to failures.
+         * 
+         * @param heavyLoad the render time of the heavy blocks, as a fraction of their play time
+         * @param lightLoad the render time of the light blocks, as a fraction of their play time
+         * @return the block size after each modeled callback
+         */
+        public function checkBlockAdaptation(heavyLoad:Number = 0.8, lightLoad:Number = 0.1):Array
+        {
+            var handler:AudioSampleHandler = new AudioSampleHandler(AudioSampleHandler.MIN_FRAMES_PER_CALLBACK);
+            handler.adaptive = true;
+            var framePeriod:Number = 1000 / AudioDescriptor.RATE_44100;
+            var sizes:Array = [];
+            var i:int;
+            
+            // Enough blocks to double up to the largest size, then to settle and halve back down
+            for (i = 0; i < 8; i++) {
+                handler.adaptBlockSize(heavyLoad * handler.framesPerCallback * framePeriod, handler.framesPerCallback);
+                sizes.push(handler.framesPerCallback);
+            }
+            var grown:Boolean = handler.framesPerCallback == AudioSampleHandler.MAX_FRAMES_PER_CALLBACK;
+            for (i = 0; i < 8 * handler.settleCallbacks; i++) {
+                handler.adaptBlockSize(lightLoad * handler.framesPerCallback * framePeriod, handler.framesPerCallback);
+                sizes.push(handler.framesPerCallback);
+            }
+            if (!grown || handler.framesPerCallback != AudioSampleHandler.MIN_FRAMES_PER_CALLBACK) {
+                failures.push("block adaptation");
+            }
+            return sizes;
+        }
+        
+        /**
+         * The hashes of a set of results by scene name, in the form goldenHashes takes,
+         * for recording new goldens.
+         */
+        public static function hashesOf(results:Array):Object
+        {
+            var hashes:Object = {};
+            for each (var result:RenderResult in results) {
+                hashes[result.name] = result.hash;
+            }
+            return hashes;
+        }
+    }
+}
@@ -0,0 +1,122 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  NOTEFLIGHT LLC
+//  Copyright 2009 Noteflight LLC
+// 
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+package com.noteflight.standingwave3.benchmark
+{
+    import __AS3__.vec.Vector;
+    
+    import com.noteflight.standingwave3.elements.*;
+    
+    /**
+     * The measurements from rendering one BenchmarkScene.
+     */
+    public class RenderResult
+    {
+        public var name:String;
+        
+        /** Frames rendered */
+        public var frames:Number = 0;
+        
+        /** Wall clock milliseconds spent in AudioPerformer.getSample() */
+        public var renderTime:Number = 0;
+        
+        /** The most live sample memory seen at any block boundary, in bytes */
+        public var peakMemory:Number = 0;
+        
+        /** Samples and blocks of sample memory allocated while rendering, from AudioPerformer.blockAllocations */
+        public var allocations:Number = 0;
+        
+        /** The index of the last block that allocated anything, or -1 if none did */
+        public var lastAllocatingBlock:int = -1;
+        
+        /** Milliseconds spent rendering each block, in order */
+        public var blockTimes:Vector.<Number> = new Vector.<Number>();
+        
+        /** Hash of the whole render, from Sample.checksum() */
+        public var hash:Number = Sample.CHECKSUM_SEED;
+        
+        /** The whole render, if the benchmark was asked to keep it */
+        public var output:Sample;
+        
+        /** The seconds of audio that were rendered */
+        public var duration:Number = 0;
+        
+        public function RenderResult(name:String)
+        {
+            this.name = name;
+        }
+        
+        /**
+         * Seconds of audio rendered per second of rendering. Above 1 is faster than real time.
+         */
+        public function get realtimeFactor():Number
+        {
+            return renderTime > 0 ? duration * 1000 / renderTime : Number.POSITIVE_INFINITY;
+        }
+        
+        /**
+         * The block render time below which a given fraction of blocks fell.
+         * @param p the fraction, from 0 to 1. 0.5 is the median, 0.99 the 99th percentile
+         */
+        public function blockTimePercentile(p:Number):Number
+        {
+            if (blockTimes.length == 0) {
+                return 0;
+            }
+            var sorted:Vector.<Number> = blockTimes.concat();
+            sorted.sort(compareNumbers);
+            var i:int = Math.min(sorted.length - 1, Math.max(0, Math.ceil(p * sorted.length) - 1));
+            return sorted[i];
+        }
+        
+        /**
+         * True if this render hashes the same as a stored golden hash.
+         */
+        public function matchesHash(goldenHash:Number):Boolean
+        {
+            return hash == goldenHash;
+        }
+        
+        /**
+         * True if this render is within a tolerance of a stored golden render, sample for sample.
+         * Requires the benchmark to have kept the output.
+         */
+        public function matchesGolden(golden:Sample, tolerance:Number = 1e-4):Boolean
+        {
+            if (!output) {
+                throw new Error("RenderResult.matchesGolden() requires the output to have been kept.");
+            }
+            return golden.frameCount == output.frameCount 
+                && Sample.maxDifference(output, golden) <= tolerance;
+        }
+        
+        public function toString():String
+        {
+            return name + ": " + realtimeFactor.toFixed(1) + "x realtime"
+                + ", block ms p50 " + blockTimePercentile(0.5)
+                + " p95 " + blockTimePercentile(0.95)
+                + " p99 " + blockTimePercentile(0.99)
+                + " max " + blockTimePercentile(1)
+                + ", peak memory " + Math.round(peakMemory / 1024) + "k"
+                + ", hash " + hash.toString(16);
+        }
+        
+        private static function compareNumbers(a:Number, b:Number):Number
+        {
+            return a - b;
+        }
+    }
+}
@@ -0,0 +1,115 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  NOTEFLIGHT LLC
+//  Copyright 2009 Noteflight LLC
+// 
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+package com.noteflight.standingwave3.elements
+{
+    import __AS3__.vec.Vector;
+    
+    import flash.utils.ByteArray;
+    
+    /**
+     * A ChannelView reads and writes one channel of a Sample's memory in place, without copying
+     * it into a Vector. Get one with Sample.getChannelView().
+     * 
+     * For tight loops, skip getValue() and setValue() and use the awave memory directly:
+     * the frame at index i is the float at bytes position + i * stride.
+     * 
+     * A view is only valid until its Sample is reallocated or destroyed.
+     */
+    public class ChannelView
+    {
+        private var _bytes:ByteArray;
+        private var _position:uint;
+        private var _stride:uint;
+        private var _length:int;
+        
+        public function ChannelView(bytes:ByteArray, position:uint, stride:uint, length:int)
+        {
+            _bytes = bytes;
+            _position = position;
+            _stride = stride;
+            _length = length;
+        }
+        
+        /** The awave memory that the view reads and writes */
+        public function get bytes():ByteArray
+        {
+            return _bytes;
+        }
+        
+        /** The byte position of the first frame of the view */
+        public function get position():uint
+        {
+            return _position;
+        }
+        
+        /** The number of bytes from one frame of the channel to the next */
+        public function get stride():uint
+        {
+            return _stride;
+        }
+        
+        /** The number of frames in the view */
+        public function get length():int
+        {
+            return _length;
+        }
+        
+        public function getValue(index:int):Number
+        {
+            _bytes.position = _position + index * _stride;
+            return _bytes.readFloat();
+        }
+        
+        public function setValue(index:int, value:Number):void
+        {
+            _bytes.position = _position + index * _stride;
+            _bytes.writeFloat(value);
+        }
+        
+        /**
+         * Copy a run of frames out of the view into a Vector, which must be long enough.
+         */
+        public function readInto(data:Vector.<Number>, index:int = 0, numFrames:int = -1, dataOffset:int = 0):void
+        {
+            if (numFrames < 0) {
+                numFrames = _length - index;
+            }
+            var p:uint = _position + index * _stride;
+            for (var i:int = 0; i < numFrames; i++) {
+                _bytes.position = p;
+                data[dataOffset + i] = _bytes.readFloat();
+                p += _stride;
+            }
+        }
+        
+        /**
+         * Copy a run of frames from a Vector into the view.
+         */
+        public function writeFrom(data:Vector.<Number>, index:int = 0, numFrames:int = -1, dataOffset:int = 0):void
+        {
+            if (numFrames < 0) {
+                numFrames = Math.min(data.length - dataOffset, _length - index);
+            }
+            var p:uint = _position + index * _stride;
+            for (var i:int = 0; i < numFrames; i++) {
+                _bytes.position = p;
+                _bytes.writeFloat(data[dataOffset + i]);
+                p += _stride;
+            }
+        }
+    }
+}
@@ -0,0 +1,318 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  NOTEFLIGHT LLC
+//  Copyright 2009 Noteflight LLC
+// 
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+package com.noteflight.standingwave3.elements
+{
+	import __AS3__.vec.Vector;
+	
+	import com.noteflight.standingwave3.modulation.Mod;
+	
+	import flash.utils.ByteArray;
+	
+	/**
+	 * A CommandBuffer queues up Sample operations and runs them all with a single call into
+	 * the Alchemical Wave lib. Each call to a Sample method has to marshal its arguments into C,
+	 * which adds up when a block of output takes hundreds of operations. A CommandBuffer instead
+	 * writes each operation as a fixed size record straight into sample memory, and execute()
+	 * runs the whole list in C.
+	 * 
+	 * Operations run in the order they were queued, and nothing happens to the Samples until execute()
+	 * is called. Don't destroy any Sample that has a queued operation before then.
+	 */
+	public class CommandBuffer
+	{
+		// Opcodes, which must match the AWAVE_COMMAND_ constants in libawave.h
+		public static const SET_SAMPLES:int = 1;
+		public static const CHANGE_GAIN:int = 2;
+		public static const MIX_IN:int = 3;
+		public static const MIX_IN_PAN:int = 4;
+		public static const MULTIPLY_IN:int = 5;
+		public static const COPY:int = 6;
+		public static const ENVELOPE:int = 7;
+		public static const WAVETABLE_IN:int = 8;
+		public static const BIQUAD_SWEEP:int = 9;
+		public static const OVERDRIVE:int = 10;
+		public static const CLIP:int = 11;
+		public static const CONVOLVE:int = 12;
+		public static const SHAPE:int = 13;
+		
+		/** Each command record is 6 ints and 10 floats */
+		public static const COMMAND_BYTES:int = 64;
+		
+		/** Mono sample whose memory holds the command records */
+		private var _memory:Sample;
+		private var _capacity:int;
+		private var _count:int = 0;
+		
+		/** The Samples written to by queued commands, whose channel data must be invalidated after execution */
+		private var _targets:Vector.<Sample> = new Vector.<Sample>();
+		
+		/**
+		 * Create a new CommandBuffer.
+		 * @param capacity the maximum number of commands that can be queued between calls to execute() 
+		 */
+		public function CommandBuffer(capacity:int = 256)
+		{
+			_capacity = capacity;
+			_memory = new Sample(new AudioDescriptor(AudioDescriptor.RATE_44100, AudioDescriptor.CHANNELS_MONO), 
+				capacity * COMMAND_BYTES / 4, true);
+			_memory.memoryCategory = Sample.MEMORY_SCRATCH;
+		}
+		
+		/**
+		 * The number of commands queued.
+		 */
+		public function get length():int
+		{
+			return _count;
+		}
+		
+		/**
+		 * The maximum number of commands that can be queued.
+		 */
+		public function get capacity():int
+		{
+			return _capacity;
+		}
+		
+		/**
+		 * Forget all queued commands without running them.
+		 */
+		public function clear():void
+		{
+			_count = 0;
+			_targets.length = 0;
+		}
+		
+		/**
+		 * Run all queued commands in order, then clear the buffer.
+		 */
+		public function execute():void
+		{
+			if (_count == 0) {
+				return;
+			}
+			var ran:int = Sample.executeCommands(_memory.getSamplePointer(), _count);
+			for each (var target:Sample in _targets) {
+				target.invalidateChannelData();
+			}
+			var queued:int = _count;
+			clear();
+			if (ran < queued) {
+				throw new Error("CommandBuffer stopped at unknown command " + ran);
+			}
+		}
+		
+		/**
+		 * Returns the phase left by a queued wavetableIn() after execute(), or its initial phase before.
+		 * @param index the value returned by wavetableIn()
+		 */
+		public function getWavetablePhase(index:int):Number
+		{
+			var mem:ByteArray = Sample.awaveMemory;
+			mem.position = _memory.getSamplePointer() + index * COMMAND_BYTES + 24;
+			return mem.readFloat();
+		}
+		
+		//
+		// Queued operations, which mirror the Sample methods of the same names
+		//
+		
+		public function setSamples(target:Sample, value:Number, targetOffset:Number, numFrames:Number):void
+		{
+			numFrames = Math.min(numFrames, target.frameCount - targetOffset);
+			write(SET_SAMPLES, target, targetOffset, 0, numFrames, 0, value);
+		}
+		
+		public function changeGain(target:Sample, leftGain:Number=1.0, rightGain:Number=-1):void
+		{
+			if (rightGain < 0) {
+				rightGain = leftGain;
+			}
+			write(CHANGE_GAIN, target, 0, 0, target.frameCount, 0, leftGain, rightGain);
+		}
+		
+		public function mixIn(target:Sample, source:IDirectAccessSource, gain:Number=1.0, targetOffset:Number=0, 
+			sourceOffset:Number=0, numFrames:Number=-1):void
+		{
+			if (numFrames < 0) {
+				numFrames = target.frameCount;
+			}
+			numFrames = Math.min(numFrames, target.frameCount - targetOffset, source.frameCount - sourceOffset);
+			write(MIX_IN, target, targetOffset, sourcePointer(source, sourceOffset), numFrames, 0, gain, gain);
+		}
+		
+		/**
+		 * Mix a mono source into a stereo target.
+		 */
+		public function mixInPan(target:Sample, source:IDirectAccessSource, leftGain:Number=1.0, rightGain:Number=1.0, 
+			targetOffset:Number=0, sourceOffset:Number=0, numFrames:Number=-1):void
+		{
+			if (numFrames < 0) {
+				numFrames = target.frameCount;
+			}
+			numFrames = Math.min(numFrames, target.frameCount - targetOffset, source.frameCount - sourceOffset);
+			write(MIX_IN_PAN, target, targetOffset, sourcePointer(source, sourceOffset), numFrames, 0, leftGain, rightGain);
+		}
+		
+		public function multiplyIn(target:Sample, source:IDirectAccessSource, gain:Number=1.0, targetOffset:Number=0, 
+			sourceOffset:Number=0, numFrames:Number=-1):void
+		{
+			if (numFrames < 0) {
+				numFrames = target.frameCount;
+			}
+			numFrames = Math.min(numFrames, target.frameCount - targetOffset, source.frameCount - sourceOffset);
+			write(MULTIPLY_IN, target, targetOffset, sourcePointer(source, sourceOffset), numFrames, 0, gain);
+		}
+		
+		/**
+		 * Copy a source with the same descriptor into the start of the target.
+		 */
+		public function copy(target:Sample, source:Sample):void
+		{
+			source.commitChannelData();
+			write(COPY, target, 0, source.getSamplePointer(), Math.min(target.frameCount, source.frameCount), 0);
+		}
+		
+		public function envelope(target:Sample, mp:Mod, numFrames:Number=-1, targetOffset:Number=0):void
+		{
+			if (numFrames < 0) {
+				numFrames = target.frameCount;
+			}
+			numFrames = Math.min(numFrames, target.frameCount - targetOffset);
+			write(ENVELOPE, target, targetOffset, 0, numFrames, 0, mp.y0, mp.y1, mp.y2, mp.y3);
+		}
+		
+		/**
+		 * Queue a wavetable scan, as in Sample.wavetableInDirectAccessSource().
+		 * @return an index with which to read the resulting phase from getWavetablePhase() after execute()
+		 */
+		public function wavetableIn(target:Sample, table:IDirectAccessSource, tableSize:int, 
+			initialPhase:Number, phaseAdd:Number, phaseReset:Number, 
+			targetOffset:Number, numFrames:Number, pitchMod:Mod = null):int
+		{
+			if (isNaN(tableSize) || isNaN(initialPhase) || isNaN(phaseAdd) || tableSize == 0) {
+				throw new Error("Bad parameters to CommandBuffer.wavetableIn");
+			}
+			if (numFrames < 0) {
+				numFrames = target.frameCount;
+			}
+			numFrames = Math.min(numFrames, target.frameCount - targetOffset);
+			var y1:Number = pitchMod ? pitchMod.y1 : 0;
+			var y2:Number = pitchMod ? pitchMod.y2 : 0;
+			write(WAVETABLE_IN, target, targetOffset, table.getSamplePointer(), numFrames, tableSize * target.channels, 
+				initialPhase, phaseAdd, phaseReset, y1, y2);
+			return _count - 1;
+		}
+		
+		/**
+		 * Queue a biquad sweep, as in Sample.biquadSweep().
+		 */
+		public function biquadSweep(target:Sample, state:Sample, type:int, startFrequency:Number, endFrequency:Number,
+			startQ:Number, endQ:Number, startGain:Number=0, endGain:Number=0):void
+		{
+			write(BIQUAD_SWEEP, target, 0, state.getSamplePointer(), target.frameCount, type,
+				target.descriptor.rate, startFrequency, endFrequency, startQ, endQ, startGain, endGain);
+			_targets.push(state);
+		}
+		
+		public function overdrive(target:Sample):void
+		{
+			write(OVERDRIVE, target, 0, 0, target.frameCount, 0);
+		}
+		
+		public function clip(target:Sample):void
+		{
+			write(CLIP, target, 0, 0, target.frameCount, 0);
+		}
+		
+		/**
+		 * Queue a convolution, as in Sample.convolve().
+		 */
+		public function convolve(target:Sample, state:uint, dryMix:Number=0, wetMix:Number=1):void
+		{
+			write(CONVOLVE, target, 0, state, target.frameCount, 0, dryMix, wetMix);
+		}
+		
+		/**
+		 * Queue waveshaping, as in Sample.shape().
+		 */
+		public function shape(target:Sample, shaper:uint):void
+		{
+			write(SHAPE, target, 0, shaper, target.frameCount, 0);
+		}
+		
+		/**
+		* Destroy the CommandBuffer to free its memory. Queued commands are dropped.
+		*/
+		public function destroy():void
+		{
+			clear();
+			_memory.destroy();
+		}
+		
+		/**
+		 * Returns a pointer into a source, making sure a Sample's channel data has reached its sample memory first.
+		 */
+		private function sourcePointer(source:IDirectAccessSource, offset:Number):uint
+		{
+			if (source is Sample) {
+				Sample(source).commitChannelData();
+				checkInterleaved(Sample(source));
+			}
+			return source.getSamplePointer(offset);
+		}
+		
+		/**
+		 * Commands address whole frames of interleaved memory, so planar samples can't be queued.
+		 */
+		private function checkInterleaved(sample:Sample):void
+		{
+			if (sample.planar && sample.channels > 1) {
+				throw new Error("CommandBuffer does not support planar samples");
+			}
+		}
+		
+		/**
+		 * Write one command record into the buffer.
+		 */
+		private function write(op:int, target:Sample, targetOffset:Number, source:uint, numFrames:Number, param:int, ...args):void
+		{
+			if (_count >= _capacity) {
+				throw new Error("CommandBuffer is full");
+			}
+			
+			checkInterleaved(target);
+			
+			// Pending edits to the channel data must reach sample memory before the command runs
+			target.commitChannelData();
+			_targets.push(target);
+			
+			var mem:ByteArray = Sample.awaveMemory;
+			mem.position = _memory.getSamplePointer() + _count * COMMAND_BYTES;
+			mem.writeInt(op);
+			mem.writeUnsignedInt(target.getSamplePointer(targetOffset));
+			mem.writeUnsignedInt(source);
+			mem.writeInt(target.channels);
+			mem.writeInt(Math.max(0, Math.floor(numFrames)));
+			mem.writeInt(param);
+			for (var i:int = 0; i < 10; i++) {
+				mem.writeFloat(i < args.length ? args[i] : 0);
+			}
+			_count++;
+		}
+	}
+}
@@ -0,0 +1,35 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  NOTEFLIGHT LLC
+//  Copyright 2009 Noteflight LLC
+// 
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+package com.noteflight.standingwave3.elements
+{
+	/**
+	 * An IBufferedSource is an audio source that can render its next frames into a Sample
+	 * supplied by the caller, rather than allocating a new Sample for every block. A renderer
+	 * that keeps its own scratch samples can then pull blocks without allocating anything.
+	 */
+	public interface IBufferedSource extends IAudioSource
+	{
+		/**
+		 * Render the next frames into a sample, replacing its contents, and advance the
+		 * position just as getSample() would. 
+		 * 
+		 * @param target a sample of this source's descriptor, exactly numFrames long. See Sample.resize().
+		 * @param numFrames the number of frames to render
+		 */
+		function renderInto(target:Sample, numFrames:Number):void;
+	}
+}
@@ -0,0 +1,44 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  NOTEFLIGHT LLC
+//  Copyright 2009 Noteflight LLC
+// 
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+package com.noteflight.standingwave3.elements
+{
+	/**
+	 * An IGainRampSource is a direct access source whose signal is another direct access source
+	 * scaled by a gain that ramps over time, like a fade. A mixer can mix the unscaled source
+	 * with the ramp applied in the same pass, using Sample.mixInRampDirectAccessSource(),
+	 * rather than rendering the scaled signal first.
+	 */
+	public interface IGainRampSource extends IDirectAccessSource
+	{
+		/**
+		 * The source whose signal is scaled by the ramp, addressed with the same frame offsets
+		 * as this source. May be null if there is no direct access source underneath.
+		 */
+		function get unscaledSource():IDirectAccessSource;
+		
+		/**
+		 * Return the gain applied over a range of frames, as an Object with start and end
+		 * gain factors and a curve, one of the Sample.RAMP_ constants.
+		 * Returns null if the gain over this range is not a single ramp.
+		 * The Object may be reused by the next call, so read it before calling again.
+		 * 
+		 * @param offset the first frame of the range
+		 * @param numFrames the length of the range
+		 */
+		function getGainRamp(offset:Number, numFrames:Number):Object;
+	}
+}
@@ -0,0 +1,31 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  NOTEFLIGHT LLC
+//  Copyright 2009 Noteflight LLC
+// 
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+package com.noteflight.standingwave3.elements
+{
+	/**
+	 * An IReleasableSource is an audio source holding native memory that it only needs while it
+	 * is sounding, such as a modulation curve. AudioPerformer releases each voice once it has finished.
+	 */
+	public interface IReleasableSource extends IAudioSource
+	{
+		/**
+		 * Free the native memory held for rendering. The source may still be reset and rendered
+		 * afterwards, and will allocate what it needs again.
+		 */
+		function releaseState():void;
+	}
+}
@@ -0,0 +1,72 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  NOTEFLIGHT LLC
+//  Copyright 2009 Noteflight LLC
+// 
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+package com.noteflight.standingwave3.elements
+{
+    /**
+     * RenderQuality is the engine-wide quality tier. At FULL quality everything renders at full fidelity.
+     * DRAFT quality is for interactive previews on slow clients. Voices are built at 22050 Hz, and optionally
+     * in mono, using voiceDescriptor(). The one upsample to 44.1k stereo at the output, through StandardizeFilter,
+     * is linear rather than cubic. Filters that are not essential to the sound, like echo and reverb, are bypassed.
+     * 
+     * A draft performance is built by creating its sources and its AudioPerformer with
+     * voiceDescriptor(), and playing the performer through a StandardizeFilter.
+     */
+    public class RenderQuality
+    {
+        public static const FULL:int = 0;
+        public static const DRAFT:int = 1;
+        
+        /** Whether draft voices are rendered in mono */
+        public static var draftMono:Boolean = false;
+        
+        private static var _level:int = FULL;
+        
+        /**
+         * The current quality tier, FULL or DRAFT.
+         */
+        public static function get level():int
+        {
+            return _level;
+        }
+        
+        public static function set level(value:int):void
+        {
+            _level = value;
+            Sample.setRenderQuality(value);
+        }
+        
+        /**
+         * True at DRAFT quality.
+         */
+        public static function get draft():Boolean
+        {
+            return _level == DRAFT;
+        }
+        
+        /**
+         * The descriptor to render voices with at the current quality, given their full quality descriptor.
+         */
+        public static function voiceDescriptor(descriptor:AudioDescriptor):AudioDescriptor
+        {
+            if (_level != DRAFT) {
+                return descriptor;
+            }
+            return new AudioDescriptor(AudioDescriptor.RATE_22050, 
+                draftMono ? AudioDescriptor.CHANNELS_MONO : descriptor.channels);
+        }
+    }
+}
@@ -0,0 +1,221 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  NOTEFLIGHT LLC
+//  Copyright 2009 Noteflight LLC
+// 
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+package com.noteflight.standingwave3.elements
+{
+    import __AS3__.vec.Vector;
+    
+    import flash.utils.Dictionary;
+    import flash.utils.getQualifiedClassName;
+    import flash.utils.getTimer;
+    
+    /**
+     * RenderTrace records a timeline of the work done to render each block: the block itself, each voice,
+     * each bus, each filter stage and each awave kernel call. Spans are written into a ring of preallocated
+     * Vectors, so the oldest are overwritten once it fills. toJSON() exports what it holds in the Chrome
+     * trace-event format, to be opened in chrome://tracing or another trace viewer, showing which voice
+     * or stage made a block miss its deadline.
+     * 
+     * Tracing is off until start() is called. The render code tests enabled before recording a span,
+     * and kernel calls are only timed while tracing, so there is no cost to speak of when it is off.
+     * Times come from getTimer(), which counts whole milliseconds, so short spans show with no duration.
+     */
+    public class RenderTrace
+    {
+        /** Span categories */
+        public static const BLOCK:String = "block";
+        public static const VOICE:String = "voice";
+        public static const BUS:String = "bus";
+        public static const FILTER:String = "filter";
+        public static const KERNEL:String = "kernel";
+        
+        /** The number of span starts and ends held by default */
+        public static const DEFAULT_CAPACITY:int = 65536;
+        
+        /** Whether spans are being recorded. Read by the render code; set by start() and stop(). */
+        public static var enabled:Boolean = false;
+        
+        private static var _capacity:int = 0;
+        private static var _next:int = 0;
+        private static var _count:int = 0;
+        private static var _dropped:Number = 0;
+        
+        /** The ring of events, each the start or the end of a span */
+        private static var _begins:Vector.<Boolean>;
+        private static var _names:Vector.<String>;
+        private static var _categories:Vector.<String>;
+        private static var _times:Vector.<int>;
+        private static var _frames:Vector.<Number>;
+        private static var _positions:Vector.<Number>;
+        
+        /** Unqualified class names, by class */
+        private static var _classNames:Dictionary = new Dictionary();
+        
+        /**
+         * Begin recording, discarding any earlier spans.
+         * @param capacity the number of span starts and ends to hold
+         */
+        public static function start(capacity:int = DEFAULT_CAPACITY):void
+        {
+            if (capacity != _capacity) {
+                _capacity = capacity;
+                _begins = new Vector.<Boolean>(capacity, true);
+                _names = new Vector.<String>(capacity, true);
+                _categories = new Vector.<String>(capacity, true);
+                _times = new Vector.<int>(capacity, true);
+                _frames = new Vector.<Number>(capacity, true);
+                _positions = new Vector.<Number>(capacity, true);
+            }
+            clear();
+            enabled = true;
+            Sample.setKernelTracing(true);
+        }
+        
+        /**
+         * Stop recording, keeping the spans recorded so far for toJSON().
+         */
+        public static function stop():void
+        {
+            enabled = false;
+            Sample.setKernelTracing(false);
+        }
+        
+        /**
+         * Discard the spans recorded so far.
+         */
+        public static function clear():void
+        {
+            _next = 0;
+            _count = 0;
+            _dropped = 0;
+        }
+        
+        /**
+         * The number of span starts and ends held.
+         */
+        public static function get count():int
+        {
+            return _count;
+        }
+        
+        /**
+         * The number of span starts and ends overwritten since recording began, because the ring was full.
+         */
+        public static function get dropped():Number
+        {
+            return _dropped;
+        }
+        
+        /**
+         * Record the start of a span, to be closed by a matching call to end().
+         * @param name what is being done, such as a source's class name or a kernel
+         * @param category one of the span categories
+         * @param frames the number of frames being rendered, if any
+         * @param position the frame position of the work within the performance, if known
+         */
+        public static function begin(name:String, category:String, frames:Number = 0, position:Number = NaN):void
+        {
+            if (_capacity == 0) {
+                return;
+            }
+            var i:int = _next;
+            _begins[i] = true;
+            _names[i] = name;
+            _categories[i] = category;
+            _times[i] = getTimer();
+            _frames[i] = frames;
+            _positions[i] = position;
+            advance();
+        }
+        
+        /**
+         * Record the end of the innermost open span.
+         */
+        public static function end():void
+        {
+            if (_capacity == 0) {
+                return;
+            }
+            var i:int = _next;
+            _begins[i] = false;
+            _names[i] = null;
+            _categories[i] = null;
+            _times[i] = getTimer();
+            advance();
+        }
+        
+        private static function advance():void
+        {
+            _next = (_next + 1) % _capacity;
+            if (_count < _capacity) {
+                _count++;
+            } else {
+                _dropped++;
+            }
+        }
+        
+        /**
+         * The class name of an object without its package, for naming spans.
+         */
+        public static function nameOf(object:Object):String
+        {
+            var type:Object = object.constructor;
+            var name:String = _classNames[type];
+            if (!name) {
+                name = getQualifiedClassName(object);
+                name = _classNames[type] = name.substr(name.lastIndexOf(":") + 1);
+            }
+            return name;
+        }
+        
+        /**
+         * The recorded spans as a Chrome trace-event JSON document, oldest first. 
+         * Ends whose starts have been overwritten are left out.
+         */
+        public static function toJSON():String
+        {
+            var events:Array = [];
+            var depth:int = 0;
+            var first:int = _capacity ? (_next - _count + _capacity) % _capacity : 0;
+            for (var n:int = 0; n < _count; n++) {
+                var i:int = (first + n) % _capacity;
+                var event:String;
+                if (_begins[i]) {
+                    depth++;
+                    event = '{"name":"' + quote(_names[i]) + '","cat":"' + _categories[i] + '","ph":"B","ts":' + _times[i] * 1000 
+                        + ',"pid":1,"tid":1';
+                    if (_frames[i] > 0 || !isNaN(_positions[i])) {
+                        event += ',"args":{"frames":' + _frames[i];
+                        if (!isNaN(_positions[i])) {
+                            event += ',"position":' + _positions[i];
+                        }
+                        event += '}';
+                    }
+                    events.push(event + '}');
+                } else if (depth > 0) {
+                    depth--;
+                    events.push('{"ph":"E","ts":' + _times[i] * 1000 + ',"pid":1,"tid":1}');
+                }
+            }
+            return '{"traceEvents":[\n' + events.join(',\n') + '\n],"displayTimeUnit":"ms"}';
+        }
+        
+        private static function quote(s:String):String
+        {
+            return s.replace(/\\/g, "\\\\").replace(/"/g, '\\"');
+        }
+    }
+}
@@ -21,6 +21,7 @@ package com.noteflight.standingwave3.elements
 	import cmodule.awave.CLibInit;
 	
 	import com.noteflight.standingwave3.modulation.Mod;
+	import com.noteflight.standingwave3.modulation.ModulationCursor;
 	
 	import flash.media.Sound;
 	import flash.utils.ByteArray;
@@ -34,9 +35,29 @@ package com.noteflight.standingwave3.elements
      * data may be manipulated easily through the built in functions.
      * Alternatively, the sample data can be requested as a Vector of Numbers, manipulated,
      * and then committed back to the sample memory.
+     * 
+     * Sample memory is normally interleaved, frame by frame. A Sample may instead be planar, holding each
+     * channel in its own contiguous plane, so that per-channel operations run over contiguous memory
+     * and more than two channels can be supported. Planar samples are interleaved at the output boundary,
+     * by writeBytes() and standardize(). Operations that only work on interleaved memory throw an Error
+     * when given a planar sample with more than one channel.
      */
     public final class Sample implements IAudioSource, IRandomAccessSource, IDirectAccessSource
     {
+    	/** Owner categories for sample memory accounting. See memoryCategory and getMemoryUsage(). */
+    	public static const MEMORY_ALL:int = -1;
+    	public static const MEMORY_TRANSIENT:int = 0;
+    	public static const MEMORY_CACHE:int = 1;
+    	public static const MEMORY_POOL:int = 2;
+    	public static const MEMORY_SCRATCH:int = 3;
+    	
+    	/** Gain ramp curves for the ramped mixes. Exponential ramps move evenly in decibels. See mixInRampDirectAccessSource(). */
+    	public static const RAMP_LINEAR:int = 0;
+    	public static const RAMP_EXPONENTIAL:int = 1;
+    	
+    	/** The frames of a mono noise state Sample needed for each channel of noise. See noise(). */
+    	public static const NOISE_STATE:int = 8;
+    	
     	/** Uint "pointer" to the sample memory in the awave. */
     	protected var _samplePointer:uint;
     	
@@ -46,6 +67,9 @@ package com.noteflight.standingwave3.elements
         /** The number of 44.1k frames in the sample. */
         protected var _frames:Number;    
         
+        /** The number of frames the sample memory was allocated for, which resize() may not exceed. */
+        protected var _capacity:Number;
+        
         /** To keep the sample memory and channelData Vectors in sync */
         protected var _channelDatainvalid:Boolean = true;
         protected var _awaveMemoryinvalid:Boolean = false;
@@ -53,8 +77,21 @@ package com.noteflight.standingwave3.elements
         /** Audio descriptor for this sample. */
         protected var _descriptor:AudioDescriptor;
         
+        /** True if each channel is held in its own plane of _frames floats, rather than interleaved. */
+        protected var _planar:Boolean = false;
+        
+        /** The accounting category last assigned, kept so that an evicted sample can be restored into it. */
+        protected var _memoryCategory:int = MEMORY_TRANSIENT;
+        
         /** Audio cursor position, expressed as a sample frame index. For use as an IAudioSource.  */
         protected var _position:Number;
+        
+        /**
+         * True while this sample is kept and reused by the source that returned it, such as an AudioPerformer
+         * with reuseBuffers. Callers may read it, or transform it in place, until they next ask that source
+         * for a sample. destroy() leaves a borrowed sample alone; its owner clears this before destroying it.
+         */
+        public var borrowed:Boolean = false;
 
 		
 
@@ -63,6 +100,13 @@ package com.noteflight.standingwave3.elements
 		private static var _awaveMemory:ByteArray; 
 		private static var ns:Namespace = new Namespace("cmodule.awave");
 		private static var _pool:MemoryPool;
+		private static var _evictionHandlers:Vector.<Function> = new Vector.<Function>();
+		private static var _memoryBudget:Number = 0;
+		private static var _allocations:Number = 0;
+		
+		/** Settings passed to the awave wavetable and delay functions, reused from call to call */
+		private static var _scanSettings:Object = new Object();
+		private static var _delaySettings:Object = new Object();
 		
 		
         /**
@@ -71,8 +115,9 @@ package com.noteflight.standingwave3.elements
          * @param frames the number of frames in this Sample. required.
          * @param zeroB whether the new sample must be all 0s, otherwise contains unpredictable content
          * @param samplePointer a sample buffer pointer to reuse, in the case of cloned samples. if 0, new memory is allocated.
+         * @param planar whether the sample memory holds each channel in its own plane, rather than interleaved
          */
-        public function Sample(descriptor:AudioDescriptor, numFrames:Number = -1, zero:Boolean = true, samplePointer:uint = 0)
+        public function Sample(descriptor:AudioDescriptor, numFrames:Number = -1, zero:Boolean = true, samplePointer:uint = 0, planar:Boolean = false)
         {
         	if (!_awave) {
         		// Creates the Alchemy C Lib when you first need a Sample
@@ -80,8 +125,10 @@ package com.noteflight.standingwave3.elements
         	}
         	// trace("New sample " + numFrames);
             this._descriptor = descriptor;
+            this._planar = planar;
             this._channelData = new Array();  
             this._frames = numFrames;
+            this._capacity = numFrames;
             if (_frames < 0) {
             	// Leaving this in for non-backwards compatibile situations
             	throw new Error("Zero length and variable size Samples are no longer supported in Standing Wave.");
@@ -98,22 +145,106 @@ package com.noteflight.standingwave3.elements
             
             // If a pool-sourced buffer was not available, then allocate new memory
             if (this._samplePointer == 0) {
-              this._samplePointer = Sample.allocateSampleMemory(numFrames, descriptor.channels, zero);
+              this._samplePointer = Sample.allocate(numFrames, descriptor.channels, zero);
             }
+            _allocations++;
             _position = 0; 
             
            
             
         }
 
+        /**
+         * Allocates raw sample memory. If the memory budget would be exceeded, the eviction handlers
+         * are asked to release memory first.
+         */
         public static function allocateSampleMemory(numFrames:Number, channels:Number, zero:Boolean = false):uint {
+            _allocations++;
+            return Sample.allocate(numFrames, channels, zero);
+        }
+        
+        private static function allocate(numFrames:Number, channels:Number, zero:Boolean):uint {
             var pointer:uint =  Sample._awave.allocateSampleMemory(numFrames, channels, zero ? 1 : 0);
+            if (pointer == 0 && relieveMemoryPressure(numFrames * channels * 4) > 0) {
+            	pointer = Sample._awave.allocateSampleMemory(numFrames, channels, zero ? 1 : 0);
+            }
             if(pointer == 0) {
                 throw new Error("Unable to allocate memory")
             } else {
                 return pointer;
             }
         }
+        
+        /**
+         * Returns the live bytes of sample memory owned by a category, one of the MEMORY_ constants.
+         * Unlike getAwaveMemoryUsage(), this counts exactly the sample memory in use, not the size of the heap.
+         */
+        public static function getMemoryUsage(category:int = MEMORY_ALL):Number {
+        	if (!_awave) {
+        		Sample.initAlchemicalWaveSingleton();
+        	}
+        	return Sample._awave.memoryUsage(category);
+        }
+        
+        /**
+         * The number of Samples constructed and blocks of sample memory allocated since startup.
+         * Compare it before and after rendering to check that a render loop allocates nothing.
+         */
+        public static function get allocations():Number {
+        	return _allocations;
+        }
+        
+        /**
+         * A hard limit on the total bytes of sample memory, or 0 for no limit.
+         * When an allocation would exceed the budget, the eviction handlers are asked to release memory,
+         * and if they cannot free enough the allocation throws an Error.
+         * Lowering the budget below the current usage evicts immediately.
+         */
+        public static function get memoryBudget():Number {
+        	return _memoryBudget;
+        }
+        
+        public static function set memoryBudget(bytes:Number):void {
+        	if (!_awave) {
+        		Sample.initAlchemicalWaveSingleton();
+        	}
+        	_memoryBudget = Math.max(0, bytes);
+        	Sample._awave.setMemoryBudget(_memoryBudget);
+        	var over:Number = getMemoryUsage() - _memoryBudget;
+        	if (_memoryBudget > 0 && over > 0) {
+        		relieveMemoryPressure(over);
+        	}
+        }
+        
+        /**
+         * Adds a function that releases sample memory when the budget is exceeded.
+         * It is called as handler(bytes:Number):Number with the number of bytes needed,
+         * and returns the number of bytes it freed.
+         */
+        public static function addEvictionHandler(handler:Function):void {
+        	if (_evictionHandlers.indexOf(handler) < 0) {
+        		_evictionHandlers.push(handler);
+        	}
+        }
+        
+        public static function removeEvictionHandler(handler:Function):void {
+        	var i:int = _evictionHandlers.indexOf(handler);
+        	if (i >= 0) {
+        		_evictionHandlers.splice(i, 1);
+        	}
+        }
+        
+        /**
+         * Asks the eviction handlers, in the order they were added, to free at least this many bytes.
+         * @return the number of bytes freed
+         */
+        public static function relieveMemoryPressure(bytes:Number):Number {
+        	var freed:Number = 0;
+        	for (var h:int = 0; h < _evictionHandlers.length && freed < bytes; h++) {
+        		freed += _evictionHandlers[h](bytes - freed);
+        	}
+        	return freed;
+        }
 
         /**
          * Returns the total sample memory size in bytes
@@ -125,6 +256,46 @@ package com.noteflight.standingwave3.elements
 			return _awaveMemory.bytesAvailable;
         }
         
+        /**
+         * The awave memory itself, for classes in this package that write to sample memory directly.
+         */
+        internal static function get awaveMemory():ByteArray {
+        	return _awaveMemory;
+        }
+        
+        /**
+         * Runs a block of commands that have been written into sample memory by a CommandBuffer.
+         * @return the number of commands run
+         */
+        internal static function executeCommands(pointer:uint, count:int):int {
+        	return Sample._awave.execute(pointer, count);
+        }
+        
+        /**
+         * Passes the render quality to the awave kernels. See RenderQuality.
+         */
+        internal static function setRenderQuality(level:int):void {
+        	if (!_awave) {
+        		Sample.initAlchemicalWaveSingleton();
+        	}
+        	Sample._awave.setQuality(level);
+        }
+
+        /**
+         * Routes every awave call through an AwaveTrace while RenderTrace is recording,
+         * and straight to the library otherwise.
+         */
+        internal static function setKernelTracing(on:Boolean):void {
+        	if (!_awave) {
+        		Sample.initAlchemicalWaveSingleton();
+        	}
+        	if (on && !(_awave is AwaveTrace)) {
+        		Sample._awave = new AwaveTrace(_awave);
+        	} else if (!on && _awave is AwaveTrace) {
+        		Sample._awave = AwaveTrace(_awave).target;
+        	}
+        }
+
         private static function initAlchemicalWaveSingleton():void {
         	var oldTime:Number = getTimer();
         	var loader:CLibInit = new CLibInit();   
@@ -145,9 +316,94 @@ package com.noteflight.standingwave3.elements
         	if (numFrames < frameCount) {
         		return;
         	} else {
-        		_samplePointer = Sample._awave.reallocateSampleMemory(frameCount, numFrames, descriptor.channels);
+        		var pointer:uint = reallocSampleMemory(numFrames);
+        		if (pointer == 0 && relieveMemoryPressure((numFrames - frameCount) * descriptor.channels * 4) > 0) {
+        			pointer = reallocSampleMemory(numFrames);
+        		}
+        		if (pointer == 0) {
+        			// The old memory is still valid
+        			throw new Error("Unable to allocate memory");
+        		}
+        		_samplePointer = pointer;
         		_frames = numFrames;
+        		_capacity = numFrames;
+        		_allocations++;
+        		invalidateChannelData();
+        	}
+        }
+        
+        /**
+         * The number of frames this sample can be resized to without allocating.
+         */
+        public function get capacity():Number {
+        	return _capacity;
+        }
+        
+        /**
+         * Changes the length of this sample within the memory it already has, so that one scratch sample
+         * can be reused for blocks of different lengths. Frames past the old length hold whatever was
+         * last in them. Use realloc() to grow past the capacity.
+         */
+        public function resize(numFrames:Number):void {
+        	if (numFrames > _capacity) {
+        		throw new Error("Cannot resize a Sample past its capacity of " + _capacity + " frames.");
+        	}
+        	requireInterleaved("resize");
+        	if (_awaveMemoryinvalid) {
+        		commitChannelData();
+        	}
+        	_frames = numFrames;
+        	invalidateChannelData();
+        }
+        
+        private function reallocSampleMemory(numFrames:Number):uint {
+        	if (_planar) {
+        		return Sample._awave.reallocatePlanarSampleMemory(_samplePointer, frameCount, numFrames, descriptor.channels);
+        	}
+        	return Sample._awave.reallocateSampleMemory(_samplePointer, frameCount, numFrames, descriptor.channels);
+        }
+        
+        /**
+         * The owner category that this sample's memory is accounted to, one of the MEMORY_ constants.
+         * New samples are transient. Clones share the category of their memory.
+         */
+        public function get memoryCategory():int {
+        	return _samplePointer ? Sample._awave.memoryCategory(_samplePointer) : MEMORY_TRANSIENT;
+        }
+        
+        public function set memoryCategory(category:int):void {
+        	_memoryCategory = category;
+        	if (_samplePointer) {
+        		Sample._awave.setMemoryCategory(_samplePointer, category);
+        	}
+        }
+        
+        /**
+         * Frees this sample's memory, keeping its format and length, so that it can be
+         * refilled later after calling restore(). Used to evict caches under memory pressure.
+         * Clones sharing the memory must not be used until it is restored.
+         */
+        public function evict():void {
+        	if (_samplePointer) {
+        		Sample._awave.deallocateSampleMemory(_samplePointer);
+        		_samplePointer = 0;
         		invalidateChannelData();
+        		_awaveMemoryinvalid = false;
+        	}
+        }
+        
+        /** True if this sample's memory has been freed by evict() */
+        public function get evicted():Boolean {
+        	return _samplePointer == 0;
+        }
+        
+        /**
+         * Allocates fresh, zeroed memory for an evicted sample, in its previous category.
+         */
+        public function restore():void {
+        	if (_samplePointer == 0) {
+        		_samplePointer = Sample.allocateSampleMemory(_capacity, _descriptor.channels, true);
+        		Sample._awave.setMemoryCategory(_samplePointer, _memoryCategory);
         	}
         }
         
@@ -161,6 +417,14 @@ package com.noteflight.standingwave3.elements
             return _descriptor.channels;
         }
         
+        /**
+         * Whether each channel of this sample is held in its own plane, rather than interleaved.
+         */
+        public function get planar():Boolean
+        {
+            return _planar;
+        }
+        
         /**
          * Return duration in seconds
          */
@@ -174,7 +438,8 @@ package com.noteflight.standingwave3.elements
          */
         public function clear():void
         {
-            Sample._awave.setSamples(getSamplePointer(), _descriptor.channels, _frames, 0.0);
+            // Planes are contiguous, so either layout can be zeroed in one pass
+            Sample._awave.setSamples(getSamplePointer(), 1, _frames * _descriptor.channels, 0.0);
             invalidateChannelData();
         }    
         
@@ -224,7 +489,13 @@ package com.noteflight.standingwave3.elements
         		commitChannelData();
         	}
         	var numFrames:int = toOffset - fromOffset;
-            var returnSample:Sample = new Sample(descriptor, numFrames);
+            var returnSample:Sample = new Sample(descriptor, numFrames, true, 0, _planar);
+            if (_planar) {
+            	for (var c:int = 0; c < _descriptor.channels; c++) {
+            		Sample._awave.mixIn(returnSample.getPlanePointer(c), getPlanePointer(c, fromOffset), 1, numFrames, 1.0, 1.0);
+            	}
+            	return returnSample;
+            }
             var returnSamplePointer:uint = returnSample.getSamplePointer(0);
             var thisSamplePointer:uint = getSamplePointer(fromOffset);
             Sample._awave.mixIn(returnSamplePointer, thisSamplePointer, _descriptor.channels, numFrames, 1.0, 1.0);
@@ -249,6 +520,7 @@ package com.noteflight.standingwave3.elements
          * Returns a pointer to the sample memory, adjusted to the offset provided.
          * The user should be extremely careful accessing the memory returned.
          * Generally, this is READ-ONLY and used exclusively by other methods of Sample.
+         * For planar samples, this points into the first plane.
          * @param offset the number of frames into the sample. Defaults to 0, the sample start. 
          */ 
         public function getSamplePointer(offset:Number = 0):uint {
@@ -257,11 +529,101 @@ package com.noteflight.standingwave3.elements
         		throw new Error("Sample pointer out of range.");
         		return null; 
         	}
-        	if (_descriptor.channels == AudioDescriptor.CHANNELS_STEREO) {
+        	if (_descriptor.channels == AudioDescriptor.CHANNELS_STEREO && !_planar) {
         		offset *= 2;
         	}
         	return _samplePointer + (4 * offset);  // 4 bytes per float * offset in frames
         }
+        
+        /**
+         * Returns a pointer into one plane of a planar sample's memory.
+         * @param channel the channel whose plane to point into
+         * @param offset the number of frames into the plane 
+         */
+        public function getPlanePointer(channel:int, offset:Number = 0):uint {
+        	if (!_planar && _descriptor.channels > 1) {
+        		throw new Error("Interleaved samples have no planes.");
+        	}
+        	if (channel < 0 || channel >= _descriptor.channels || offset < 0 || offset > _frames) {
+        		throw new Error("Plane pointer out of range.");
+        	}
+        	return _samplePointer + 4 * (channel * _frames + offset);
+        }
+        
+        /**
+         * Converts this sample's memory to planar layout. As with standardize(), clones sharing
+         * the old memory are left pointing at freed memory.
+         */
+        public function toPlanar():void {
+        	if (_planar) {
+        		return;
+        	}
+        	if (_awaveMemoryinvalid) {
+        		commitChannelData();
+        	}
+        	if (_descriptor.channels > 1) {
+        		var planes:uint = Sample.allocateSampleMemory(_frames, _descriptor.channels);
+        		Sample._awave.deinterleave(planes, _samplePointer, _descriptor.channels, _frames, _frames);
+        		_pool.release(_samplePointer, _capacity * _descriptor.channels);
+        		_samplePointer = planes;
+        		_capacity = _frames;
+        	}
+        	_planar = true;
+        }
+        
+        /**
+         * Converts this sample's memory back to interleaved layout. As with standardize(), clones sharing
+         * the old memory are left pointing at freed memory.
+         */
+        public function toInterleaved():void {
+        	if (!_planar) {
+        		return;
+        	}
+        	if (_awaveMemoryinvalid) {
+        		commitChannelData();
+        	}
+        	if (_descriptor.channels > 1) {
+        		var frames:uint = Sample.allocateSampleMemory(_frames, _descriptor.channels);
+        		Sample._awave.interleave(frames, _samplePointer, _descriptor.channels, _frames, _frames);
+        		_pool.release(_samplePointer, _capacity * _descriptor.channels);
+        		_samplePointer = frames;
+        		_capacity = _frames;
+        	}
+        	_planar = false;
+        }
+        
+        /**
+         * Throws if this is a planar sample with more than one channel, for operations that need interleaved memory.
+         */
+        private function requireInterleaved(operation:String):void {
+        	if (_planar && _descriptor.channels > 1) {
+        		throw new Error(operation + "() does not support planar samples.");
+        	}
+        }
+        
+        /**
+         * Returns a pointer to interleaved source memory, throwing if the source is a planar sample.
+         */
+        private static function interleavedSourcePointer(source:IDirectAccessSource, offset:Number):uint {
+        	if (source is Sample && Sample(source).planar && source.descriptor.channels > 1) {
+        		throw new Error("Planar sources can only be used with planar samples.");
+        	}
+        	return source.getSamplePointer(offset);
+        }
+        
+        /**
+         * Returns a pointer to the memory of a source to use for one plane of this planar sample.
+         * A mono source is used for every plane, and a planar source with the same channels gives its corresponding plane.
+         */
+        private function sourcePlanePointer(source:IDirectAccessSource, channel:int, offset:Number):uint {
+        	if (source.descriptor.channels == 1) {
+        		return source.getSamplePointer(offset);
+        	}
+        	if (source is Sample && Sample(source).planar && source.descriptor.channels == _descriptor.channels) {
+        		return Sample(source).getPlanePointer(channel, offset);
+        	}
+        	throw new Error("Planar samples can only use mono sources or planar sources with the same channels.");
+        }
           
         /**
          * IDirectAccessSources can be used similarly to IAudioSource.
@@ -345,9 +707,9 @@ package com.noteflight.standingwave3.elements
         
         /**
         * Operations directly on sample memory invalidate our channel data.
-        * This is only called internally.
+        * This is only called internally, by Sample and CommandBuffer.
         */
-        protected function invalidateChannelData():void { 
+        internal function invalidateChannelData():void { 
         	_channelDatainvalid = true;
         }
         
@@ -390,23 +752,34 @@ package com.noteflight.standingwave3.elements
         }   
                       
         /** 
-        * Creates a new channel Vector from the contents of sample memory 
+        * Creates a new channel Vector from the contents of sample memory.
+        * Interleaved channels are pulled out natively a chunk at a time, so that
+        * the floats can be read back contiguously.
         */ 
         protected function getChannelVector(channel:int=0, offset:Number=0, numFrames:Number=-1):Vector.<Number> 
         {	
-        	var positionAddPerLoop:int = 0; 
-        	if (_descriptor.channels == 2) {
-        		positionAddPerLoop = 4; // 4 bytes per float, to skip alt channels
-        	}
         	if (numFrames == -1) { numFrames = _frames; }
         	var fcount:int = numFrames; 
         	var slice:Vector.<Number> = new Vector.<Number>(fcount, true); // create if missing
-        	// Now populate it from memory
-        	_awaveMemory.position = getSamplePointer(offset) + (channel*4); // +4 bytes for right channel
-        	for (var s:int=0; s<fcount; s++) {
-        		slice[s] = _awaveMemory.readFloat(); // read the current position and advance 4 bytes
-        		_awaveMemory.position += positionAddPerLoop; // jump ahead to the next frame
+        	var s:int;
+        	if (_planar || _descriptor.channels == 1) {
+        		// Already contiguous
+        		_awaveMemory.position = _planar ? getPlanePointer(channel, offset) : getSamplePointer(offset);
+        		for (s=0; s<fcount; s++) {
+        			slice[s] = _awaveMemory.readFloat(); // read the current position and advance 4 bytes
+        		}
+        		return slice;
+        	}
+        	var chunk:uint = fetchChannelChunk();
+        	for (var done:int=0; done<fcount; done+=CHANNEL_CHUNK) {
+        		var count:int = Math.min(CHANNEL_CHUNK, fcount - done);
+        		Sample._awave.extractChannel(chunk, getSamplePointer(offset + done), _descriptor.channels, channel, count);
+        		_awaveMemory.position = chunk;
+        		for (s=0; s<count; s++) {
+        			slice[done + s] = _awaveMemory.readFloat();
+        		}
         	}
+        	_pool.release(chunk, CHANNEL_CHUNK);
         	return slice;
         }
         
@@ -416,16 +789,108 @@ package com.noteflight.standingwave3.elements
         protected function vectorToSampleMemory(data:Vector.<Number>, channel:int=0, offset:Number=0, numFrames:Number=-1):void 
         {
         	if (numFrames == -1) { numFrames = _frames; }
-        	var positionAddPerLoop:int = 0;
-        	if (_descriptor.channels == 2) {
-        		positionAddPerLoop = 4; // 4 bytes per float, to skip alt channels
-        	}
         	var fcount:int = Math.floor(numFrames);
-        	_awaveMemory.position = getSamplePointer(offset) + (channel*4); // 4 byte offset for right channel
-        	for (var s:int=0; s<fcount; s++) {
-        		_awaveMemory.writeFloat( data[s] );
-        		_awaveMemory.position += positionAddPerLoop;
+        	var s:int;
+        	if (_planar || _descriptor.channels == 1) {
+        		_awaveMemory.position = _planar ? getPlanePointer(channel, offset) : getSamplePointer(offset);
+        		for (s=0; s<fcount; s++) {
+        			_awaveMemory.writeFloat( data[s] );
+        		}
+        		return;
+        	}
+        	var chunk:uint = fetchChannelChunk();
+        	for (var done:int=0; done<fcount; done+=CHANNEL_CHUNK) {
+        		var count:int = Math.min(CHANNEL_CHUNK, fcount - done);
+        		_awaveMemory.position = chunk;
+        		for (s=0; s<count; s++) {
+        			_awaveMemory.writeFloat( data[done + s] );
+        		}
+        		Sample._awave.insertChannel(getSamplePointer(offset + done), chunk, _descriptor.channels, channel, count);
+        	}
+        	_pool.release(chunk, CHANNEL_CHUNK);
+        }
+        
+        /** Frames of one channel moved at a time between sample memory and a Vector. A pooled buffer size. */
+        private static const CHANNEL_CHUNK:int = 8192;
+        
+        private static function fetchChannelChunk():uint
+        {
+        	var chunk:uint = _pool.fetch(CHANNEL_CHUNK, false);
+        	return chunk ? chunk : Sample.allocateSampleMemory(CHANNEL_CHUNK, 1);
+        }
+        
+        /**
+         * Copy one channel of this sample out into a new mono Sample, natively.
+         * @param channel the channel to copy
+         * @param offset the first frame to copy
+         * @param numFrames the number of frames to copy, or -1 for the rest of the sample
+         */
+        public function extractChannel(channel:int, offset:Number = 0, numFrames:Number = -1):Sample
+        {
+        	if (_awaveMemoryinvalid) {
+        		commitChannelData();
+        	}
+        	if (numFrames < 0) {
+        		numFrames = _frames - offset;
+        	}
+        	var result:Sample = new Sample(new AudioDescriptor(_descriptor.rate, AudioDescriptor.CHANNELS_MONO), numFrames, false);
+        	if (_planar) {
+        		Sample._awave.copy(result.getSamplePointer(), getPlanePointer(channel, offset), 1, Math.floor(numFrames), 0);
+        	} else {
+        		Sample._awave.extractChannel(result.getSamplePointer(), getSamplePointer(offset), _descriptor.channels, channel, Math.floor(numFrames));
+        	}
+        	return result;
+        }
+        
+        /**
+         * Overwrite one channel of this sample with the contents of a mono Sample, natively,
+         * leaving the other channels alone.
+         * @param source a mono Sample
+         * @param channel the channel to write
+         * @param offset the frame at which to start writing
+         */
+        public function insertChannel(source:Sample, channel:int, offset:Number = 0):void
+        {
+        	if (source.channels != 1) {
+        		throw new Error("Sample.insertChannel() requires a mono source.");
+        	}
+        	if (_awaveMemoryinvalid) {
+        		commitChannelData();
+        	}
+        	if (source._awaveMemoryinvalid) {
+        		source.commitChannelData();
+        	}
+        	var numFrames:Number = Math.min(source.frameCount, _frames - offset);
+        	if (_planar) {
+        		Sample._awave.copy(getPlanePointer(channel, offset), source.getSamplePointer(), 1, Math.floor(numFrames), 0);
+        	} else {
+        		Sample._awave.insertChannel(getSamplePointer(offset), source.getSamplePointer(), _descriptor.channels, channel, Math.floor(numFrames));
+        	}
+        	invalidateChannelData();
+        }
+        
+        /**
+         * Get a view of one channel of this sample that reads and writes sample memory in place,
+         * without copying it into a Vector. This is the way to analyze or edit long samples.
+         * Any channelData is discarded, since the view may change the memory underneath it.
+         * The view is only valid until the sample is reallocated or destroyed.
+         * @param channel the channel to view
+         * @param offset the first frame of the view
+         * @param numFrames the length of the view, or -1 for the rest of the sample
+         */
+        public function getChannelView(channel:int, offset:Number = 0, numFrames:Number = -1):ChannelView
+        {
+        	if (_awaveMemoryinvalid) {
+        		commitChannelData();
+        	}
+        	if (numFrames < 0) {
+        		numFrames = _frames - offset;
+        	}
+        	invalidateChannelData();
+        	if (_planar) {
+        		return new ChannelView(_awaveMemory, getPlanePointer(channel, offset), 4, Math.floor(numFrames));
         	}
+        	return new ChannelView(_awaveMemory, getSamplePointer(offset) + channel * 4, _descriptor.channels * 4, Math.floor(numFrames));
         }
         
         /* Sample manipulations that use the new fast AlchemicalWave libs */       
@@ -439,7 +904,13 @@ package com.noteflight.standingwave3.elements
          */
         public function setSamples(value:Number, targetOffset:Number, numFrames:Number):void 
         {
-            Sample._awave.setSamples(getSamplePointer(targetOffset), _descriptor.channels, numFrames, value);   
+        	if (_planar) {
+        		for (var c:int = 0; c < _descriptor.channels; c++) {
+        			Sample._awave.setSamples(getPlanePointer(c, targetOffset), 1, numFrames, value);
+        		}
+        	} else {
+            	Sample._awave.setSamples(getSamplePointer(targetOffset), _descriptor.channels, numFrames, value);
+            }
             invalidateChannelData();
         }   
         
@@ -473,10 +944,17 @@ package com.noteflight.standingwave3.elements
         	if (numFrames < 0) {
         		numFrames = _frames; // if unspecified, mix into the entire sample
         	}
-			thisSamplePointer = getSamplePointer(targetOffset); // mix in at this position
-			mixSamplePointer = source.getSamplePointer(sourceOffset); // mix from this position
 			numFrames = Math.min(numFrames, _frames - targetOffset); // don't mix more frames than are left in our target 
 			numFrames = Math.min(numFrames, source.frameCount - sourceOffset); // and don't mix more than are left in our source
+			if (_planar) {
+				for (var c:int = 0; c < _descriptor.channels; c++) {
+					Sample._awave.mixIn(getPlanePointer(c, targetOffset), sourcePlanePointer(source, c, sourceOffset), 1, Math.floor(numFrames), gain, gain);
+				}
+				invalidateChannelData();
+				return;
+			}
+			thisSamplePointer = getSamplePointer(targetOffset); // mix in at this position
+			mixSamplePointer = interleavedSourcePointer(source, sourceOffset); // mix from this position
 			Sample._awave.mixIn(thisSamplePointer, mixSamplePointer, _descriptor.channels, Math.floor(numFrames), gain, gain);  
 			invalidateChannelData();
        } 
@@ -520,10 +998,89 @@ package com.noteflight.standingwave3.elements
 			mixSamplePointer = source.getSamplePointer(sourceOffset); // mix from this position
 			numFrames = Math.min(numFrames, _frames - targetOffset); // don't mix more frames than are left in our target 
 			numFrames = Math.min(numFrames, source.frameCount - sourceOffset); // and don't mix more than are left in our source
-			Sample._awave.mixInPan(thisSamplePointer, mixSamplePointer, Math.floor(numFrames), leftGain, rightGain);  
+			if (_planar) {
+				// The mono source goes into each plane at its own gain
+				Sample._awave.mixIn(getPlanePointer(0, targetOffset), mixSamplePointer, 1, Math.floor(numFrames), leftGain, leftGain);
+				Sample._awave.mixIn(getPlanePointer(1, targetOffset), mixSamplePointer, 1, Math.floor(numFrames), rightGain, rightGain);
+			} else {
+				Sample._awave.mixInPan(thisSamplePointer, mixSamplePointer, Math.floor(numFrames), leftGain, rightGain);
+			}
 			invalidateChannelData();
        } 
        
+       /**
+        * Mix part or all of another IDirectAccessSource into this Sample, with the gain ramping
+        * from startGain to endGain across the mixed frames. This applies a fade in the same pass
+        * as the mix, instead of enveloping the source first.
+        * An exponential ramp can't reach silence, so it stops at -100 dB.
+        * @param source the IDirectAccessSource, with valid data at the sourceOffset
+        * @param sourceOffset the number of frames into our source to begin mixing from
+        * @param startGain the gain factor at the first mixed frame
+        * @param endGain the gain factor just after the last mixed frame
+        * @param curve RAMP_LINEAR or RAMP_EXPONENTIAL
+        * @param targetOffset the number of frames into this target sample at which to begin mixing
+        */
+        public function mixInRampDirectAccessSource(source:IDirectAccessSource, sourceOffset:Number, startGain:Number, endGain:Number, 
+        	curve:int = RAMP_LINEAR, targetOffset:Number = 0, numFrames:Number = -1):void {
+        	if (_awaveMemoryinvalid) {
+        		commitChannelData(); // make sure we're in sync
+        	}
+        	if (numFrames < 0) {
+        		numFrames = _frames; // if unspecified, mix into the entire sample
+        	}
+			numFrames = Math.min(numFrames, _frames - targetOffset); // don't mix more frames than are left in our target 
+			numFrames = Math.min(numFrames, source.frameCount - sourceOffset); // and don't mix more than are left in our source
+			if (_planar) {
+				for (var c:int = 0; c < _descriptor.channels; c++) {
+					Sample._awave.mixInRamp(getPlanePointer(c, targetOffset), sourcePlanePointer(source, c, sourceOffset), 1, Math.floor(numFrames), 
+						startGain, endGain, startGain, endGain, curve);
+				}
+			} else {
+				Sample._awave.mixInRamp(getSamplePointer(targetOffset), interleavedSourcePointer(source, sourceOffset), _descriptor.channels, Math.floor(numFrames),
+					startGain, endGain, startGain, endGain, curve);
+			}
+			invalidateChannelData();
+        }
+        
+       /**
+        * Mix part or all of a mono IDirectAccessSource into this stereo Sample, with the left and right
+        * gains each ramping across the mixed frames. Fades and pan moves are applied in the same pass as the mix.
+        * @param source the mono IDirectAccessSource, with valid data at the sourceOffset
+        * @param sourceOffset the number of frames into our source to begin mixing from
+        * @param leftStart the left gain factor at the first mixed frame
+        * @param leftEnd the left gain factor just after the last mixed frame
+        * @param rightStart the right gain factor at the first mixed frame
+        * @param rightEnd the right gain factor just after the last mixed frame
+        * @param curve RAMP_LINEAR or RAMP_EXPONENTIAL
+        * @param targetOffset the number of frames into this target sample at which to begin mixing
+        */
+        public function mixInPanRampDirectAccessSource(source:IDirectAccessSource, sourceOffset:Number, 
+        	leftStart:Number, leftEnd:Number, rightStart:Number, rightEnd:Number, 
+        	curve:int = RAMP_LINEAR, targetOffset:Number = 0, numFrames:Number = -1):void {
+        	var mixSamplePointer:uint;
+        	
+        	if (_descriptor.channels != AudioDescriptor.CHANNELS_STEREO) {
+        		throw new Error("mixInPanRampDirectAccessSource() only works with stereo samples.");
+        	}
+        	if (_awaveMemoryinvalid) {
+        		commitChannelData(); // make sure we're in sync
+        	}  
+        	if (numFrames < 0) {
+        		numFrames = _frames; // if unspecified, mix into the entire sample
+        	}  
+			numFrames = Math.min(numFrames, _frames - targetOffset); // don't mix more frames than are left in our target 
+			numFrames = Math.min(numFrames, source.frameCount - sourceOffset); // and don't mix more than are left in our source
+			mixSamplePointer = source.getSamplePointer(sourceOffset); // mix from this position
+			if (_planar) {
+				// The mono source goes into each plane with its own ramp
+				Sample._awave.mixInRamp(getPlanePointer(0, targetOffset), mixSamplePointer, 1, Math.floor(numFrames), leftStart, leftEnd, leftStart, leftEnd, curve);
+				Sample._awave.mixInRamp(getPlanePointer(1, targetOffset), mixSamplePointer, 1, Math.floor(numFrames), rightStart, rightEnd, rightStart, rightEnd, curve);
+			} else {
+				Sample._awave.mixInPanRamp(getSamplePointer(targetOffset), mixSamplePointer, Math.floor(numFrames), leftStart, leftEnd, rightStart, rightEnd, curve);
+			}
+			invalidateChannelData();
+        }
+       
        public function envelope(mp:Mod, numFrames:Number=-1, offset:Number = 0):void 
        {
        		if (_awaveMemoryinvalid) {
@@ -532,7 +1089,13 @@ package com.noteflight.standingwave3.elements
         	if (numFrames < 0) {
         		numFrames = _frames; // if unspecified, mix into the entire sample
         	} 
-       		Sample._awave.envelope(getSamplePointer(offset), _descriptor.channels, numFrames, mp); 
+        	if (_planar) {
+        		for (var c:int = 0; c < _descriptor.channels; c++) {
+        			Sample._awave.envelope(getPlanePointer(c, offset), 1, numFrames, mp);
+        		}
+        	} else {
+       			Sample._awave.envelope(getSamplePointer(offset), _descriptor.channels, numFrames, mp); 
+       		}
        		invalidateChannelData();
        } 
         
@@ -567,10 +1130,17 @@ package com.noteflight.standingwave3.elements
         	if (numFrames < 0) {
         		numFrames = _frames; // if unspecified, mix into the entire sample
         	}
-			thisSamplePointer = getSamplePointer(targetOffset); // mix in at this position
-			mixSamplePointer = source.getSamplePointer(sourceOffset); // mix from this position
 			numFrames = Math.min(numFrames, _frames - targetOffset); // don't mix more frames than are left in our target 
 			numFrames = Math.min(numFrames, source.frameCount - sourceOffset); // and don't mix more than are left in our source
+			if (_planar) {
+				for (var c:int = 0; c < _descriptor.channels; c++) {
+					Sample._awave.multiplyIn(getPlanePointer(c, targetOffset), sourcePlanePointer(source, c, sourceOffset), 1, Math.floor(numFrames), gain, gain);
+				}
+				invalidateChannelData();
+				return;
+			}
+			thisSamplePointer = getSamplePointer(targetOffset); // mix in at this position
+			mixSamplePointer = interleavedSourcePointer(source, sourceOffset); // mix from this position
 			Sample._awave.multiplyIn(thisSamplePointer, mixSamplePointer, _descriptor.channels, Math.floor(numFrames), gain, gain );  
 			invalidateChannelData();
        }
@@ -608,27 +1178,195 @@ package com.noteflight.standingwave3.elements
         		throw new Error("Bad parameters to Sample.wavetableInDirectAccessSource");
         	}
         	
-        	if (pitchMod == null) {
-        	   pitchMod = new Mod(0,0,0,0);
+			numFrames = Math.min(numFrames, _frames - targetOffset); // don't mix more frames than are left in our target 
+			var settings:Object = scanSettings(tableSize, initialPhase, phaseAdd, phaseReset);
+			settings.y1 = pitchMod ? pitchMod.y1 : 0;
+			settings.y2 = pitchMod ? pitchMod.y2 : 0;
+			
+        	if (_planar) {
+        		// Scan a mono table once into the first plane, and copy it to the rest
+        		if (table.descriptor.channels != 1) {
+        			throw new Error("Planar samples can only scan mono wavetables.");
+        		}
+        		Sample._awave.wavetableIn(getPlanePointer(0, targetOffset), table.getSamplePointer(), 1, Math.floor(numFrames), settings );
+        		for (var c:int = 1; c < _descriptor.channels; c++) {
+        			Sample._awave.copy(getPlanePointer(c, targetOffset), getPlanePointer(0, targetOffset), 1, Math.floor(numFrames), 0);
+        		}
+        		invalidateChannelData();
+        		return settings.phase;
         	}
         	
         	// Double phase positions for stereo wavetables
         	// This should be moved into alchemy, I think.
-        	tableSize *= _descriptor.channels;
-        	
+        	settings.tableSize *= _descriptor.channels;
         	
 			thisSamplePointer = getSamplePointer(targetOffset); // gen to this position
-			tableSamplePointer = table.getSamplePointer(); // gen from this position
-			numFrames = Math.min(numFrames, _frames - targetOffset); // don't mix more frames than are left in our target 
-			var settings:Object = {tableSize:tableSize, phase:initialPhase, phaseAdd:phaseAdd, phaseReset:phaseReset,
-			     y1: pitchMod.y1, y2: pitchMod.y2 };
-			
+			tableSamplePointer = interleavedSourcePointer(table, 0); // gen from this position
         	Sample._awave.wavetableIn(thisSamplePointer, tableSamplePointer, _descriptor.channels, Math.floor(numFrames), settings );
         	
         	invalidateChannelData();  
         	return settings.phase;  
        	} 
        	
+       	/**
+       	 * The shared settings object for a wavetable scan, filled in with the common settings.
+       	 */
+       	private static function scanSettings(tableSize:Number, phase:Number, phaseAdd:Number, phaseReset:Number):Object
+       	{
+       		var settings:Object = _scanSettings;
+       		settings.tableSize = tableSize;
+       		settings.phase = phase;
+       		settings.phaseAdd = phaseAdd;
+       		settings.phaseReset = phaseReset;
+       		return settings;
+       	}
+       	
+       	/**
+       	 * Scan a wavetable into this Sample as wavetableInDirectAccessSource() does, with the pitch shift
+       	 * in semitones read frame by frame from a native modulation curve. The cursor is advanced past the
+       	 * scanned frames, so a voice renders its whole pitch modulation with one call per block.
+       	 * @param cursor the voice's cursor into its modulation data, at the curve position of the first frame
+       	 * @returns the new phase
+       	 */
+       	public function wavetableInCurveDirectAccessSource(table:IDirectAccessSource, tableSize:int, 
+       	    initialPhase:Number, phaseAdd:Number, phaseReset:Number, 
+       	    targetOffset:Number, numFrames:Number, cursor:ModulationCursor):Number 
+       	{
+        	if (_awaveMemoryinvalid) {
+        		commitChannelData(); // make sure we're in sync
+        	}
+        	if (numFrames < 0) {
+        		numFrames = _frames; // if unspecified, mix into the entire sample
+        	}
+        	if ( isNaN(tableSize) || isNaN(initialPhase) || isNaN(phaseAdd) || tableSize == 0) {
+        		throw new Error("Bad parameters to Sample.wavetableInCurveDirectAccessSource");
+        	}
+			numFrames = Math.floor(Math.min(numFrames, _frames - targetOffset)); 
+			var settings:Object = scanSettings(tableSize, initialPhase, phaseAdd, phaseReset);
+			settings.curve = cursor.data.curve;
+			settings.cursor = cursor.index;
+			settings.position = cursor.position;
+			
+        	if (_planar) {
+        		if (table.descriptor.channels != 1) {
+        			throw new Error("Planar samples can only scan mono wavetables.");
+        		}
+        		Sample._awave.wavetableInCurve(getPlanePointer(0, targetOffset), table.getSamplePointer(), 1, numFrames, settings );
+        		for (var c:int = 1; c < _descriptor.channels; c++) {
+        			Sample._awave.copy(getPlanePointer(c, targetOffset), getPlanePointer(0, targetOffset), 1, numFrames, 0);
+        		}
+        	} else {
+        		settings.tableSize *= _descriptor.channels;
+        		Sample._awave.wavetableInCurve(getSamplePointer(targetOffset), interleavedSourcePointer(table, 0), _descriptor.channels, numFrames, settings );
+        	}
+        	cursor.index = settings.cursor;
+        	cursor.position += numFrames;
+        	invalidateChannelData();  
+        	return settings.phase;  
+       	} 
+       	
+       	/**
+       	 * Write the values of a native modulation curve into this mono Sample, one per frame.
+       	 * @param cursor the cursor into the modulation data, which is advanced past the written frames
+       	 */
+       	public function renderCurve(cursor:ModulationCursor, targetOffset:Number = 0, numFrames:Number = -1):void
+       	{
+        	if (_descriptor.channels != 1 && !_planar) {
+        		throw new Error("renderCurve() only works with mono samples.");
+        	}
+        	if (numFrames < 0) {
+        		numFrames = _frames - targetOffset;
+        	}
+        	numFrames = Math.floor(Math.min(numFrames, _frames - targetOffset));
+        	cursor.index = Sample._awave.renderCurve(_planar ? getPlanePointer(0, targetOffset) : getSamplePointer(targetOffset), 
+        		numFrames, cursor.data.curve, cursor.index, cursor.position);
+        	cursor.position += numFrames;
+        	invalidateChannelData();
+       	}
+       	
+       	/**
+       	 * Generate a waveform directly into this sample, replacing what was there.
+       	 * The same signal is written to every channel. Saw, square and triangle waves are band-limited with PolyBLEP.
+       	 * @param wave one of the wave constants in OscillatorSource
+       	 * @param phase a phasor normalized from 0-1
+       	 * @param phaseAdd amount to add to the phasor per frame, typically frequency/samplerate
+       	 * @param amplitude the peak amplitude
+       	 * @param targetOffset offset into this sample to begin writing
+       	 * @param numFrames the number of frames to generate, or -1 for the rest of the sample
+       	 * @returns the new phase. Pass it to the next call to keep the waveform continuous
+       	 */
+       	public function oscillator(wave:int, phase:Number, phaseAdd:Number, amplitude:Number = 1.0, 
+       		targetOffset:Number = 0, numFrames:Number = -1):Number
+       	{
+        	if (_awaveMemoryinvalid) {
+        		commitChannelData(); // make sure we're in sync
+        	}
+        	if (numFrames < 0) {
+        		numFrames = _frames - targetOffset;
+        	}
+			numFrames = Math.min(numFrames, _frames - targetOffset);
+			var newPhase:Number = phase;
+			if (_planar) {
+				for (var c:int = 0; c < _descriptor.channels; c++) {
+					newPhase = Sample._awave.oscillator(getPlanePointer(c, targetOffset), 1, Math.floor(numFrames), wave, phase, phaseAdd, amplitude);
+				}
+			} else {
+				newPhase = Sample._awave.oscillator(getSamplePointer(targetOffset), _descriptor.channels, Math.floor(numFrames), wave, phase, phaseAdd, amplitude);
+			}
+			invalidateChannelData();
+			return newPhase;
+       	}
+       	
+       	/**
+       	 * Generate noise directly into this sample, replacing what was there. Each channel gets independent noise.
+       	 * @param state a mono Sample of at least 8 frames per channel, holding the generator state between calls.
+       	 * Start it zeroed or seeded with seedNoise(), and do the same again to restart the same noise.
+       	 * @param color one of the color constants in NoiseSource
+       	 * @param amplitude the peak amplitude
+       	 * @param targetOffset offset into this sample to begin writing
+       	 * @param numFrames the number of frames to generate, or -1 for the rest of the sample
+       	 */
+       	public function noise(state:Sample, color:int = 0, amplitude:Number = 1.0, 
+       		targetOffset:Number = 0, numFrames:Number = -1):void
+       	{
+        	if (_awaveMemoryinvalid) {
+        		commitChannelData(); // make sure we're in sync
+        	}
+        	if (numFrames < 0) {
+        		numFrames = _frames - targetOffset;
+        	}
+			numFrames = Math.min(numFrames, _frames - targetOffset);
+			if (state.frameCount < NOISE_STATE * _descriptor.channels) {
+				throw new Error("Noise state is too small for " + _descriptor.channels + " channels.");
+			}
+			if (_planar) {
+				for (var c:int = 0; c < _descriptor.channels; c++) {
+					Sample._awave.noise(getPlanePointer(c, targetOffset), state.getSamplePointer(NOISE_STATE * c), 1, Math.floor(numFrames), color, amplitude);
+				}
+			} else {
+				Sample._awave.noise(getSamplePointer(targetOffset), state.getSamplePointer(), _descriptor.channels, Math.floor(numFrames), color, amplitude);
+			}
+			invalidateChannelData();
+       	}
+       	
+       	/**
+       	 * Prepare this mono Sample as noise state for noise(), starting the stream chosen by seed
+       	 * rather than the one a zeroed state starts. Each channel's stream is still independent.
+       	 * @param seed any value; equal seeds give equal noise
+       	 */
+       	public function seedNoise(seed:uint):void
+       	{
+       		clear();
+       		for (var c:int = 0; c < Math.floor(_frames / NOISE_STATE); c++) {
+       			// The generator reads its seed bit for bit from the first float of each channel's state,
+       			// and replaces a zero seed with its default
+       			var channelSeed:uint = uint(seed + c * 0x9E3779B9);
+       			_awaveMemory.position = getSamplePointer(NOISE_STATE * c);
+       			_awaveMemory.writeUnsignedInt(channelSeed ? channelSeed : 1);
+       		}
+       		invalidateChannelData();
+       	}
+       	
        	
        
        	/** 
@@ -660,13 +1398,25 @@ package com.noteflight.standingwave3.elements
         	if (numFrames < 0) {
         		numFrames = _frames; // if unspecified, mix into the entire sample
         	}
-			thisSamplePointer = getSamplePointer(targetOffset); // mix in at this position
-			tableSamplePointer = source.getSamplePointer(0); // use the whole wavetable
 			numFrames = Math.min(numFrames, _frames - targetOffset); // don't mix more frames than are left in our target 
-		      var tableSize:Number = (source.frameCount - 1)*source.descriptor.channels; // minus a guard sample for interpolation
         	var phase:Number = sourceOffset / source.frameCount; // phase = fractional progress through the source
         	var phaseAdd:Number = factor / source.frameCount;
-        	var settings:Object = {tableSize:tableSize, phase:phase, phaseAdd:phaseAdd, phaseReset:0, y1:0, y2:0};
+        	var settings:Object;
+        	if (_planar) {
+        		// Resample each plane from its own source plane as a mono table
+        		for (var c:int = 0; c < _descriptor.channels; c++) {
+        			settings = scanSettings(source.frameCount - 1, phase, phaseAdd, 0);
+        			settings.y1 = settings.y2 = 0;
+        			Sample._awave.wavetableIn(getPlanePointer(c, targetOffset), sourcePlanePointer(source, c, 0), 1, Math.floor(numFrames), settings );
+        		}
+        		invalidateChannelData();
+        		return;
+        	}
+			thisSamplePointer = getSamplePointer(targetOffset); // mix in at this position
+			tableSamplePointer = interleavedSourcePointer(source, 0); // use the whole wavetable
+		      var tableSize:Number = (source.frameCount - 1)*source.descriptor.channels; // minus a guard sample for interpolation
+        	settings = scanSettings(tableSize, phase, phaseAdd, 0);
+        	settings.y1 = settings.y2 = 0;
         	Sample._awave.wavetableIn(thisSamplePointer, tableSamplePointer, _descriptor.channels, Math.floor(numFrames), settings );        	
         	invalidateChannelData();
         }
@@ -686,12 +1436,14 @@ package com.noteflight.standingwave3.elements
         	if (_awaveMemoryinvalid) { 
         		commitChannelData(); // make sure we're in sync
         	}
-        	// Create the object of delay settings to send in
-        	var settings:Object = { 
-        		length: int(ringBuffer.frameCount), 
-        		dryMix: dryMix,     
-        		wetMix: wetMix, 
-        		feedback: feedback};        	 
+        	requireInterleaved("delay");
+        	
+        	// Fill in the object of delay settings to send in
+        	var settings:Object = _delaySettings;
+        	settings.length = int(ringBuffer.frameCount);
+        	settings.dryMix = dryMix;
+        	settings.wetMix = wetMix;
+        	settings.feedback = feedback;
        		Sample._awave.delay(getSamplePointer(), ringBuffer.getSamplePointer(), _descriptor.channels, int(_frames), settings); 
        		
        		// Note that the delay() method has also now shifted the data in the ring buffer, if you're looking...
@@ -713,7 +1465,14 @@ package com.noteflight.standingwave3.elements
         	if (rightGain < 0) {
         		rightGain = leftGain;
         	}
-        	Sample._awave.changeGain(getSamplePointer(0), _descriptor.channels, _frames, leftGain, rightGain);
+        	if (_planar) {
+        		// Odd channels take the right gain, so pairs of channels keep their stereo balance
+        		for (var c:int = 0; c < _descriptor.channels; c++) {
+        			Sample._awave.changeGain(getPlanePointer(c), 1, _frames, (c % 2) ? rightGain : leftGain, 0);
+        		}
+        	} else {
+        		Sample._awave.changeGain(getSamplePointer(0), _descriptor.channels, _frames, leftGain, rightGain);
+        	}
         	invalidateChannelData();
         }
         
@@ -722,10 +1481,54 @@ package com.noteflight.standingwave3.elements
         	if (_awaveMemoryinvalid) {
         		commitChannelData();
         	}
-        	Sample._awave.normalize(getSamplePointer(0), _descriptor.channels, _frames, maxLevel); 
+        	// Planes are contiguous, so either layout can be normalized in one pass
+        	Sample._awave.normalize(getSamplePointer(0), 1, _frames * _descriptor.channels, maxLevel); 
         	invalidateChannelData();
         }
         
+        /** The starting value for checksum(), the FNV-1a offset basis */
+        public static const CHECKSUM_SEED:Number = 2166136261;
+        
+        /**
+         * Fold this sample's memory into a 32 bit hash, quantizing each value to 16 bits first.
+         * Pass the previous result to hash a render block by block.
+         * The hash depends on the memory layout, so planar and interleaved samples hash differently.
+         */
+        public function checksum(hash:Number = CHECKSUM_SEED):Number
+        {
+        	if (_awaveMemoryinvalid) {
+        		commitChannelData();
+        	}
+        	return Sample._awave.checksum(getSamplePointer(0), _frames * _descriptor.channels, hash);
+        }
+        
+        /**
+         * The largest absolute difference between the samples of two Samples of the same format,
+         * over the frames they have in common.
+         */
+        public static function maxDifference(a:Sample, b:Sample):Number
+        {
+        	if (a.channels != b.channels || a.planar != b.planar) {
+        		throw new Error("Sample.maxDifference() requires Samples of the same format.");
+        	}
+        	if (a._awaveMemoryinvalid) {
+        		a.commitChannelData();
+        	}
+        	if (b._awaveMemoryinvalid) {
+        		b.commitChannelData();
+        	}
+        	if (a.planar) {
+        		var max:Number = 0;
+        		var frames:Number = Math.min(a.frameCount, b.frameCount);
+        		for (var c:int = 0; c < a.channels; c++) {
+        			max = Math.max(max, Sample._awave.maxDifference(a.getPlanePointer(c), b.getPlanePointer(c), frames));
+        		}
+        		return max;
+        	}
+        	return Sample._awave.maxDifference(a.getSamplePointer(0), b.getSamplePointer(0), 
+        		Math.min(a.frameCount, b.frameCount) * a.channels);
+        }
+        
         /**
          * Biquad function runs a biquad filter function on the sample.
          * This function cannot be used for filters with continuously changing parameters.
@@ -739,13 +1542,140 @@ package com.noteflight.standingwave3.elements
         	if (_awaveMemoryinvalid) {
         		commitChannelData();
         	}
-        	Sample._awave.biquad(getSamplePointer(), state.getSamplePointer(), _descriptor.channels, _frames, coeffs);
-        	invalidateChannelData(); 	
-        }  
+        	if (_planar) {
+        		// Each plane runs as mono, with its own 4 floats of state
+        		for (var c:int = 0; c < _descriptor.channels; c++) {
+        			Sample._awave.biquad(getPlanePointer(c), state.getSamplePointer() + 16 * c, 1, _frames, coeffs);
+        		}
+        	} else {
+        		Sample._awave.biquad(getSamplePointer(), state.getSamplePointer(), _descriptor.channels, _frames, coeffs);
+        	}
+        	invalidateChannelData();
+        }
+
+        /**
+         * Runs a biquad filter whose coefficients are calculated natively from its parameters.
+         * Each parameter moves smoothly from its start to its end value over the length of the sample,
+         * so a filter can be swept without zipper noise by passing the previous block's end values as the start values.
+         * @params state a 4 frame state sample that is needed to hold the filter delay line state
+         * @params type the filter type, one of the BiquadFilter type constants
+         * @params startFrequency the filter frequency in Hz at the start of the sample
+         * @params endFrequency the filter frequency in Hz at the end of the sample
+         * @params startQ the filter Q or resonance at the start of the sample
+         * @params endQ the filter Q or resonance at the end of the sample
+         * @params startGain the gain in db at the start of the sample, for peak and shelf filters
+         * @params endGain the gain in db at the end of the sample, for peak and shelf filters
+         */
+        public function biquadSweep(state:Sample, type:int, startFrequency:Number, endFrequency:Number,
+            startQ:Number, endQ:Number, startGain:Number=0, endGain:Number=0):void
+        {
+        	if (_awaveMemoryinvalid) {
+        		commitChannelData();
+        	}
+        	if (_planar) {
+        		for (var c:int = 0; c < _descriptor.channels; c++) {
+        			Sample._awave.biquadSweep(getPlanePointer(c), state.getSamplePointer() + 16 * c, 1, int(_frames),
+        				type, _descriptor.rate, startFrequency, endFrequency, startQ, endQ, startGain, endGain);
+        		}
+        	} else {
+        		Sample._awave.biquadSweep(getSamplePointer(), state.getSamplePointer(), _descriptor.channels, int(_frames),
+        			type, _descriptor.rate, startFrequency, endFrequency, startQ, endQ, startGain, endGain);
+        	}
+        	invalidateChannelData();
+        }
+
+        /**
+         * Transforms this sample into a prepared impulse response for partitioned convolution.
+         * The prepared impulse is independent of this sample's memory, and may be shared by any number of convolutions.
+         * @param partitionSize the partition length in frames, a power of two up to 8192. This is also the latency of the convolution.
+         * @return a pointer to the prepared impulse, which must be released with releaseConvolutionImpulse()
+         */
+        public function prepareConvolutionImpulse(partitionSize:int=1024):uint
+        {
+        	if (_awaveMemoryinvalid) {
+        		commitChannelData();
+        	}
+        	requireInterleaved("prepareConvolutionImpulse");
+        	var impulse:uint = Sample._awave.prepareConvolutionImpulse(getSamplePointer(), _descriptor.channels, int(_frames), partitionSize);
+        	if (impulse == 0) {
+        		throw new Error("Unable to prepare convolution impulse");
+        	}
+        	return impulse;
+        }
+
+        /**
+         * Releases a prepared impulse. Its memory is freed once every convolution using it is also deallocated.
+         */
+        public static function releaseConvolutionImpulse(impulse:uint):void
+        {
+        	Sample._awave.releaseConvolutionImpulse(impulse);
+        }
+
+        /**
+         * Allocates the running state for a convolution with a prepared impulse.
+         * A mono impulse may be used for stereo convolution, in which case both channels share it.
+         * @return a pointer to the convolution state, which must be freed with deallocateConvolution()
+         */
+        public static function allocateConvolution(impulse:uint, channels:int):uint
+        {
+        	var state:uint = Sample._awave.allocateConvolution(impulse, channels);
+        	if (state == 0) {
+        		throw new Error("Unable to allocate convolution");
+        	}
+        	return state;
+        }
+
+        public static function deallocateConvolution(state:uint):void
+        {
+        	Sample._awave.deallocateConvolution(state);
+        }
+
+        /**
+         * Clears the history of a convolution state, silencing any tail in progress.
+         */
+        public static function resetConvolution(state:uint):void
+        {
+        	Sample._awave.resetConvolution(state);
+        }
+
+        /**
+         * Runs this sample through a partitioned convolution.
+         * Both the wet and dry signals are delayed by the partition size of the impulse.
+         * @param state a convolution state from allocateConvolution(), with the same number of channels as this sample
+         * @param dryMix the amount of original signal mixed into the output, as a factor
+         * @param wetMix the amount of convolved signal mixed into the output, as a factor
+         */
+        public function convolve(state:uint, dryMix:Number=0, wetMix:Number=1):void
+        {
+        	if (_awaveMemoryinvalid) {
+        		commitChannelData();
+        	}
+        	requireInterleaved("convolve");
+        	Sample._awave.convolve(getSamplePointer(), state, _descriptor.channels, int(_frames), dryMix, wetMix);
+        	invalidateChannelData();
+        }
+        
+        /**
+         * Delays this sample through a convolution state as convolve() would with no wet mix, but
+         * without the cost of convolving. For a bypassed convolution that must keep its latency.
+         * The wet output resumes cleanly when convolve() is next called with the same state.
+         * @param state a convolution state from allocateConvolution(), with the same number of channels as this sample
+         * @param dryMix the amount of original signal in the output, as a factor
+         */
+        public function convolveDry(state:uint, dryMix:Number=1):void
+        {
+        	if (_awaveMemoryinvalid) {
+        		commitChannelData();
+        	}
+        	requireInterleaved("convolveDry");
+        	Sample._awave.convolveDry(getSamplePointer(), state, _descriptor.channels, int(_frames), dryMix);
+        	invalidateChannelData();
+        }
      
         /**
          * Standardize migrates a sample with any descriptor format to 44.1k stereo.
-         * Mono signals are steroized, and 22050 Hz data is upsampled to 44100 Hz.
+         * Mono signals are steroized, and 22050 Hz data is upsampled to 44100 Hz,
+         * with cubic interpolation, or linear interpolation at draft RenderQuality.
          * There is no change to samples in the correct format.
          * This is called by the AudioSampleHandler before passing anything to Sound output,
          * but may also be used any time in the processing chain that it is needed.
@@ -755,6 +1685,7 @@ package com.noteflight.standingwave3.elements
         	if (_awaveMemoryinvalid) {
         		commitChannelData();
         	}
+        	toInterleaved();
         	if (_descriptor.rate != AudioDescriptor.RATE_44100 || 
         		_descriptor.channels != AudioDescriptor.CHANNELS_STEREO ) 
         	{
@@ -767,6 +1698,7 @@ package com.noteflight.standingwave3.elements
         		Sample._awave.standardize(newSample, _samplePointer,  _descriptor.channels, _frames, _descriptor.rate);	
         		Sample._awave.deallocateSampleMemory(_samplePointer);
         		_samplePointer = newSample;
+        		_capacity = _frames;
         		_descriptor = new AudioDescriptor(AudioDescriptor.RATE_44100, AudioDescriptor.CHANNELS_STEREO);
         		_channelData = [];  // and a descriptor change has invalidated our channelData entirely
         		invalidateChannelData();  
@@ -785,6 +1717,7 @@ package com.noteflight.standingwave3.elements
          */
         public function extractSound(soundObject:Sound, position:Number, numFrames:Number):void 
         {
+        	requireInterleaved("extractSound");
         	_awaveMemory.position = getSamplePointer();	
         	if (_descriptor.channels == 2 && _descriptor.rate == 44100) {	
         		//  Yay! We can extract the sound straight into the memory we allocated for this sample
@@ -820,6 +1753,7 @@ package com.noteflight.standingwave3.elements
             invalidateChannelData();
         }
 		public function readBytes(bytes:ByteArray):void {
+			requireInterleaved("readBytes");
 			_awaveMemory.position = getSamplePointer();
 			_awaveMemory.writeBytes(bytes);
 			invalidateChannelData();
@@ -839,6 +1773,14 @@ package com.noteflight.standingwave3.elements
         	// Awave memory is littleEndian, and the sampleEvent handler is bigEndian
         	// If we just adjust its littleEndianess, then we can use the Clib func to bang all the bytes in fast
         	destBytes.endian = "littleEndian";
+        	if (_planar && _descriptor.channels > 1) {
+        		// Interleave into temporary memory on the way out
+        		var frames:uint = Sample.allocateSampleMemory(numFrames, _descriptor.channels);
+        		Sample._awave.interleave(frames, getPlanePointer(0, offset), _descriptor.channels, numFrames, _frames);
+        		Sample._awave.writeBytes(frames, destBytes, _descriptor.channels, numFrames);
+        		Sample._awave.deallocateSampleMemory(frames);
+        		return;
+        	}
         	Sample._awave.writeBytes(getSamplePointer(offset), destBytes, _descriptor.channels, numFrames);
         } 
  
@@ -847,6 +1789,7 @@ package com.noteflight.standingwave3.elements
          */ 
         public function readWavBytes(srcBytes:ByteArray, bitDepth:int, channels:int, numFrames:Number):void 
         {
+        	requireInterleaved("readWavBytes");
         	Sample._awave.readWavBytes(getSamplePointer(), srcBytes, bitDepth, channels, Math.floor(numFrames) );
         } 
         
@@ -860,6 +1803,7 @@ package com.noteflight.standingwave3.elements
         	if (numFrames < 0) {
         		numFrames = _frames; // if unspecified, write the whole sample
         	}
+        	requireInterleaved("writeWavBytes");
         	Sample._awave.writeWavBytes(getSamplePointer(offset), destBytes, _descriptor.channels, Math.floor(numFrames));
         }   
           
@@ -872,8 +1816,14 @@ package com.noteflight.standingwave3.elements
         	if (_awaveMemoryinvalid) {
         		commitChannelData();
         	}
-        	Sample._awave.copy(getSamplePointer(), source.getSamplePointer(),
-        		 _descriptor.channels, _frames, type);
+        	if (_planar) {
+        		for (var c:int = 0; c < _descriptor.channels; c++) {
+        			Sample._awave.copy(getPlanePointer(c), sourcePlanePointer(source, c, 0), 1, _frames, type);
+        		}
+        	} else {
+        		Sample._awave.copy(getSamplePointer(), interleavedSourcePointer(source, 0),
+        			 _descriptor.channels, _frames, type);
+        	}
         	invalidateChannelData();
         }  
         
@@ -885,9 +1835,154 @@ package com.noteflight.standingwave3.elements
         	if (_awaveMemoryinvalid) {
         		commitChannelData();
         	}
-        	Sample._awave.overdrive(getSamplePointer(), _descriptor.channels, _frames);
+        	Sample._awave.overdrive(getSamplePointer(), 1, _frames * _descriptor.channels);
         	invalidateChannelData();
         }    
+        
+        /**
+        * Apply a hard clip at full scale to the sample.
+        */  
+        public function clip():void
+        {
+        	if (_awaveMemoryinvalid) {
+        		commitChannelData();
+        	}
+        	Sample._awave.clip(getSamplePointer(), 1, _frames * _descriptor.channels);
+        	invalidateChannelData();
+        }
+        
+        /**
+         * Allocates a native modulation curve, which holds keyframes for AbstractModulationData.
+         * @param type AbstractModulationData.LINE or AbstractModulationData.SPLINE
+         * @return a pointer to the curve, which must be freed with deallocateCurve()
+         */
+        public static function allocateCurve(type:int):uint
+        {
+        	if (!_awave) {
+        		Sample.initAlchemicalWaveSingleton();
+        	}
+        	var curve:uint = Sample._awave.allocateCurve(type);
+        	if (curve == 0) {
+        		throw new Error("Unable to allocate modulation curve");
+        	}
+        	return curve;
+        }
+        
+        public static function deallocateCurve(curve:uint):void
+        {
+        	Sample._awave.deallocateCurve(curve);
+        }
+        
+        public static function clearCurve(curve:uint):void
+        {
+        	Sample._awave.clearCurve(curve);
+        }
+        
+        public static function addCurveKeyframe(curve:uint, position:Number, value:Number):void
+        {
+        	if (!Sample._awave.addCurveKeyframe(curve, position, value)) {
+        		throw new Error("Unable to add modulation keyframe");
+        	}
+        }
+        
+        /**
+         * The value of a native modulation curve at a position.
+         */
+        public static function curveValue(curve:uint, position:Number):Number
+        {
+        	if (curve == 0) {
+        		return 0;
+        	}
+        	return Sample._awave.curveValue(curve, position);
+        }
+        
+        /**
+         * Copies a packed sample bank into sample memory, accounted to MEMORY_CACHE. See SampleBank.
+         * @param bytes the bank, as written by SampleBank.write()
+         * @return a pointer to the bank, which must be freed with deallocateBank()
+         */
+        public static function allocateBank(bytes:ByteArray):uint
+        {
+        	if (!_awave) {
+        		Sample.initAlchemicalWaveSingleton();
+        	}
+        	var bank:uint = Sample.allocateSampleMemory(Math.ceil(bytes.length / 4), 1);
+        	Sample._awave.setMemoryCategory(bank, MEMORY_CACHE);
+        	_awaveMemory.position = bank;
+        	_awaveMemory.writeBytes(bytes, 0, bytes.length);
+        	if (Sample._awave.checkBank(bank, bytes.length) < 0) {
+        		Sample._awave.deallocateSampleMemory(bank);
+        		throw new Error("Invalid sample bank");
+        	}
+        	return bank;
+        }
+
+        public static function deallocateBank(bank:uint):void
+        {
+        	Sample._awave.deallocateSampleMemory(bank);
+        }
+
+        /**
+         * Decodes one zone of a sample bank into this sample, which must match the zone's format and length.
+         */
+        public function decodeBankZone(bank:uint, index:int):void
+        {
+        	requireInterleaved("decodeBankZone");
+        	Sample._awave.decodeBankZone(getSamplePointer(), bank, index);
+        	invalidateChannelData();
+        }
+
+        /**
+         * Allocates an oversampling waveshaper.
+         * @param curve the curve to apply, OverdriveFilter.SOFT or OverdriveFilter.HARD
+         * @param channels the number of channels the shaper will process
+         * @param oversample the oversampling factor, 1, 2 or 4
+         * @return a pointer to the shaper, which must be freed with deallocateShaper()
+         */
+        public static function allocateShaper(curve:int, channels:int, oversample:int):uint
+        {
+        	var shaper:uint = Sample._awave.allocateShaper(curve, channels, oversample);
+        	if (shaper == 0) {
+        		throw new Error("Unable to allocate shaper with oversampling " + oversample);
+        	}
+        	return shaper;
+        }
+        
+        public static function deallocateShaper(shaper:uint):void
+        {
+        	Sample._awave.deallocateShaper(shaper);
+        }
+        
+        /**
+         * Clears the filter history of a shaper.
+         */
+        public static function resetShaper(shaper:uint):void
+        {
+        	Sample._awave.resetShaper(shaper);
+        }
+        
+        /**
+         * The number of frames, possibly fractional, by which a shaper delays its input.
+         */
+        public static function shaperLatency(shaper:uint):Number
+        {
+        	return Sample._awave.shaperLatency(shaper);
+        }
+        
+        /**
+         * Runs this sample through a waveshaper from allocateShaper(), whose state carries
+         * over to the next call so that consecutive samples join seamlessly.
+         * @param shaper a shaper with the same number of channels as this sample
+         */
+        public function shape(shaper:uint):void
+        {
+        	if (_awaveMemoryinvalid) {
+        		commitChannelData();
+        	}
+        	requireInterleaved("shape");
+        	Sample._awave.shape(getSamplePointer(), shaper, _descriptor.channels, int(_frames));
+        	invalidateChannelData();
+        }
        
         /**
          * Clone this Sample.  Note that the sample memory is shared between the
@@ -897,7 +1992,7 @@ package com.noteflight.standingwave3.elements
          */
         public function clone():IAudioSource
         {
-            var sample:Sample = new Sample(this._descriptor, this._frames, false, this._samplePointer);
+            var sample:Sample = new Sample(this._descriptor, this._frames, false, this._samplePointer, this._planar);
             return sample;
         }
         
@@ -906,9 +2001,15 @@ package com.noteflight.standingwave3.elements
          */
         public function destroy():void 
         {
+        	if (borrowed) {
+        		// Still in use by its owner
+        		return;
+        	}
         	// Offer the sample memory to the memory pool
         	// If the pool doesn't want it, it'll be free'd
-        	_pool.release(_samplePointer, _frames * _descriptor.channels);
+        	if (_samplePointer) {
+        		_pool.release(_samplePointer, _capacity * _descriptor.channels);
+        	}
         	_samplePointer = 0; // null pointer
         	for (var c:Number = 0; c < channels; c++) {
         		_channelData[c] = null;
@@ -950,6 +2051,7 @@ package com.noteflight.standingwave3.elements
 				if(sp == 0) {
 				  throw new Error("Unable to allocate memory");
 			  }
+				awave.setMemoryCategory(sp, Sample.MEMORY_POOL);
 				pool[len].push(sp);
 			}
 		}
@@ -964,6 +2066,7 @@ package com.noteflight.standingwave3.elements
 				if (len == sizes[s] && pool[len].length > 0) {
 					// Here's one we can use
 					var rslt:uint = pool[len].pop();
+					awave.setMemoryCategory(rslt, Sample.MEMORY_TRANSIENT);
 					if (zero) {
 						awave.setSamples(rslt, 1, len, 0.0);
 					}
@@ -982,6 +2085,7 @@ package com.noteflight.standingwave3.elements
 			for (var s:int; s<sizes.length; s++) {
 				if (len == sizes[s] && pool[len].length < 64) {
 					// We'll add this buffer to the pool
+					awave.setMemoryCategory(pointer, Sample.MEMORY_POOL);
 					pool[len].push(pointer);
 					// And zero it out, only if we have to when fetch
 					// awave.setSamples(pointer, 1, len, 0.0);
@@ -992,4 +2096,47 @@ package com.noteflight.standingwave3.elements
 			// So we'll just free the memory
 			awave.deallocateSampleMemory(pointer);
 		}
-	}
\ No newline at end of file
+	}	
+	import com.noteflight.standingwave3.elements.RenderTrace;
+	
+	import flash.utils.Proxy;
+	import flash.utils.flash_proxy;
+	
+	use namespace flash_proxy;
+	
+	internal dynamic class AwaveTrace extends Proxy
+	{
+		public var target:Object;
+		
+		/** Span names for each kernel, so that tracing a call doesn't build a string */
+		private var _names:Object = new Object();
+		
+		/**
+		 * This class stands in for the Alchemy lib while RenderTrace is recording,
+		 * recording a kernel span around each call that it passes through.
+		 */
+		public function AwaveTrace(aw:Object)
+		{
+			target = aw;
+		}
+		
+		override flash_proxy function callProperty(name:*, ... rest):*
+		{
+			var kernel:String = (name is QName) ? QName(name).localName : String(name);
+			var spanName:String = _names[kernel];
+			if (!spanName) {
+				spanName = _names[kernel] = "awave." + kernel;
+			}
+			RenderTrace.begin(spanName, RenderTrace.KERNEL);
+			try {
+				return target[kernel].apply(target, rest);
+			} finally {
+				RenderTrace.end();
+			}
+		}
+		
+		override flash_proxy function getProperty(name:*):*
+		{
+			return target[name];
+		}
+	}
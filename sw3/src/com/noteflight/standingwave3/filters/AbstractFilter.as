@@ -22,12 +22,25 @@ package com.noteflight.standingwave3.filters
     /**
      * An abstract implementation of the IAudioFilter interface that can be
      * overridden to supply the specific transformation for a specific filter subclass. 
+     * 
+     * Filters that transform their source's block in place should pull it with pullSample(),
+     * so that renderInto() can run the whole chain in a caller-supplied sample. While RenderTrace
+     * is recording, each pull is traced as a filter stage named for the source pulled from.
      */
-    public class AbstractFilter implements IAudioFilter   
+    public class AbstractFilter implements IAudioFilter, IBufferedSource, IReleasableSource
     {
         /** The underlying source that acts as input to this filter. */        
         protected var _source:IAudioSource;
         
+        /** 
+         * Whether this filter is essential to the sound. Filters that are not, like echo and reverb, 
+         * are bypassed at draft RenderQuality.
+         */
+        public var essential:Boolean = true;
+        
+        /** The sample passed to renderInto(), until pullSample() hands it to the filter */
+        private var _target:Sample;
+        
         /**
          * Create a new filter based on some underlying source. 
          * @param source the source that this filter transforms to produce its output.
@@ -119,7 +132,7 @@ package com.noteflight.standingwave3.filters
             // position is derived.
             //
             var startPos:Number = position;
-            var sample:Sample = _source.getSample(numFrames);
+            var sample:Sample = pullSample(numFrames);
             for (var c:Number = 0; c < sample.channels; c++)
             {
                 transformChannel(sample.channelData[c], c, startPos, numFrames);
@@ -127,6 +140,85 @@ package com.noteflight.standingwave3.filters
             return sample;
         }
 
+        /**
+         * Render the next frames into a caller-supplied sample. If the filter pulls its block with
+         * pullSample(), the source renders straight into the target and the filter transforms it there.
+         * Otherwise the filter's own block is copied into the target.
+         */
+        public function renderInto(target:Sample, numFrames:Number):void
+        {
+            _target = target;
+            var sample:Sample = getSample(numFrames);
+            _target = null;
+            if (sample != target) {
+                target.copy(sample, 0);
+                sample.destroy();
+            }
+        }
+        
+        /**
+         * Pull the next block from the source, to be transformed in place and returned from getSample().
+         * During renderInto() this is the caller's sample, rendered into by the source.
+         */
+        protected function pullSample(numFrames:Number):Sample
+        {
+            var traced:Boolean = RenderTrace.enabled;
+            if (traced) {
+                RenderTrace.begin(RenderTrace.nameOf(_source), RenderTrace.FILTER, numFrames);
+            }
+            var target:Sample = _target;
+            if (!target) {
+                target = _source.getSample(numFrames);
+            } else {
+                _target = null;
+                if (_source is IBufferedSource) {
+                    IBufferedSource(_source).renderInto(target, numFrames);
+                } else {
+                    var sample:Sample = _source.getSample(numFrames);
+                    target.copy(sample, 0);
+                    sample.destroy();
+                }
+            }
+            if (traced) {
+                RenderTrace.end();
+            }
+            return target;
+        }
+
+        /**
+         * The block getSample() would otherwise pull from the source, zeroed, without pulling the source.
+         * For a filter that keeps sounding after its source has ended.
+         */
+        protected function silentSample(numFrames:Number):Sample
+        {
+            var target:Sample = _target;
+            if (!target) {
+                return new Sample(descriptor, numFrames);
+            }
+            _target = null;
+            target.setSamples(0, 0, numFrames);
+            return target;
+        }
+
+        /**
+         * Release the source's native state, if it holds any.
+         */
+        public function releaseState():void
+        {
+            if (_source is IReleasableSource) {
+                IReleasableSource(_source).releaseState();
+            }
+        }
+
+        /**
+         * True when this filter should pass its source through unchanged, because it is not
+         * essential and the render quality is draft. 
+         */
+        protected function get bypassed():Boolean
+        {
+            return !essential && RenderQuality.draft;
+        }
+
         /**
          * @inheritDoc
          */
@@ -58,7 +58,7 @@ package com.noteflight.standingwave3.filters
         	var startPosition:Number = _source.position;
         	
         	// Pull our sample from the source downstream
-            var sample:Sample = _source.getSample(numFrames);
+            var sample:Sample = pullSample(numFrames);
             
             // Make sure our envelope has generated its shape up to this position
             // If it has to gen a lot of samples, this could be slow
@@ -34,6 +34,9 @@ package com.noteflight.standingwave3.filters
         /** Fade time in frames */
         private var _fadeFrames:Number;
         
+        /** The envelope segment applied by getSample(), reused from block to block */
+        private var _envelope:Mod = new Mod();
+        
         /**
          * Create a new AttackFilter. 
          * @param source the underlying audio source
@@ -80,9 +83,9 @@ package com.noteflight.standingwave3.filters
         {
             var startPosition:Number = _source.position;
             var framesToFade:Number = 0;
-            var sample:Sample = _source.getSample(numFrames);
+            var sample:Sample = pullSample(numFrames);
             var endPosition:Number = _source.position;
-            var mp:Mod = new Mod(); // our decay envelope segment
+            var mp:Mod = _envelope; // our decay envelope segment
             
             if (startPosition < _fadeFrames) 
             {
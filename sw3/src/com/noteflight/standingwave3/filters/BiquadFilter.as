@@ -17,30 +17,37 @@
 package com.noteflight.standingwave3.filters
 {
     import com.noteflight.standingwave3.elements.*  
-    import com.noteflight.standingwave3.utils.FilterCalculator;
     
     /**
      * Infinite Impulse Response (IIR) linear filter based on the "Direct Form 1"
      * filter structure, incorporating four delay lines from the two previous input and
      * output values.
      *  
-     * This filter can be used in three ways: as a low-pass filter that attenuates frequencies
+     * This filter can be used as a low-pass filter that attenuates frequencies
      * higher than the <code>frequency</code> property, as a high-pass filter that attenuates frequencies lower
      * than the center, or as a band-pass filter that attenuates frequencies that lie
      * further from the center.  In all three cases the <code>resonance</code> property controls
-     * the abruptness of the rolloff as a function of frequency.  The <code>type</code> property
-     * determines which filter behavior is used.  
+     * the abruptness of the rolloff as a function of frequency.  It can also be used as a peak or
+     * shelving equalizer, which boosts or cuts by the <code>gain</code> property. The <code>type</code> property
+     * determines which filter behavior is used.
+     * 
+     * The coefficients are calculated in the native biquad kernel. When a parameter changes, the next
+     * block of output sweeps smoothly from the old value to the new one, so the filter can be
+     * modulated every block without zipper noise.
      */
     public class BiquadFilter extends AbstractFilter
     {
         private var _frequency:Number;
         private var _resonance:Number;
+        private var _gain:Number = 0;
         private var _type:int;
         
         private var _state:Sample = null;  // A tiny 4 frame sample to hold our delay line (x1,x2,y1,y2)
-        private var _coeffs:Object = null; // an object of filter coefficients for the biquad
         
-        private var _calculated:Boolean = false; // true when coefficients have been calculated
+        // The parameter values at the end of the last block, where the next sweep starts
+        private var _lastFrequency:Number;
+        private var _lastResonance:Number;
+        private var _lastGain:Number;
         
         /** Low-pass filter type */
         public static const LOW_PASS_TYPE:int = 0;
@@ -51,6 +58,15 @@ package com.noteflight.standingwave3.filters
         /** Band-pass filter type (constant peak, attenuated skirt) */
         public static const BAND_PASS_TYPE:int = 2;
         
+        /** Peak EQ filter type, boosting or cutting around the frequency */
+        public static const PEAK_TYPE:int = 3;
+        
+        /** Low shelving EQ filter type, boosting or cutting below the frequency */
+        public static const LOW_SHELF_TYPE:int = 4;
+        
+        /** High shelving EQ filter type, boosting or cutting above the frequency */
+        public static const HIGH_SHELF_TYPE:int = 5;
+        
         /**
          * Construct an instance of a BiquadFilter.  Parameters may be left as defaulted and/or changed
          * later while the filter is in operation.
@@ -59,15 +75,18 @@ package com.noteflight.standingwave3.filters
          * @param type the type of filter desired
          * @param frequency the center frequency of the filter
          * @param resonance the resonance characteristic of the filter, also known as "Q"
+         * @param gain the boost or cut in db, for the peak and shelf types
          */
-        public function BiquadFilter(source:IAudioSource = null, type:int = LOW_PASS_TYPE, frequency:Number = 1000, resonance:Number = 1)
+        public function BiquadFilter(source:IAudioSource = null, type:int = LOW_PASS_TYPE, frequency:Number = 1000, resonance:Number = 1, gain:Number = 0)
         {
             super(source);
             this.type = type;
             this.frequency = frequency;
             this.resonance = resonance;
+            this.gain = gain;
             this._state = new Sample(source.descriptor, 4); 
-            this._coeffs = new Object();
+            this._state.memoryCategory = Sample.MEMORY_SCRATCH;
+            settle();
         }
 
         override public function resetPosition():void
@@ -78,7 +97,7 @@ package com.noteflight.standingwave3.filters
             if (_state) {
             	_state.setSamples(0.0, 0, 4);
             }
-           	
+            settle();
         }        
         
         /**
@@ -92,7 +111,6 @@ package com.noteflight.standingwave3.filters
         public function set type(value:int):void
         {
             _type = value;
-            invalidateCoefficients();
         }
         
         /**
@@ -106,7 +124,6 @@ package com.noteflight.standingwave3.filters
         public function set frequency(value:Number):void
         {
             _frequency = value;
-            invalidateCoefficients();
         }
         
         /**
@@ -120,48 +137,38 @@ package com.noteflight.standingwave3.filters
         public function set resonance(value:Number):void
         {
             _resonance = value;
-            invalidateCoefficients();
         }
         
         /**
-         * Called when a property change invalidates the derived coefficients for the filter. 
+         * The boost or cut in db of the peak and shelf filter types. 
          */
-        protected function invalidateCoefficients():void
+        public function get gain():Number
         {
-            _calculated = false;
+            return _gain;
+        }
+        
+        public function set gain(value:Number):void
+        {
+            _gain = value;
         }
         
         /**
-         * Called to force calculation of the derived coefficients.
+         * Jump straight to the current parameters, rather than sweeping to them over the next block.
          */
-        protected function computeCoefficients():void
+        public function settle():void
         {
-            if (_calculated) {
-                return;
-            }
-            switch (_type) {
-                case LOW_PASS_TYPE:
-                    _coeffs = FilterCalculator.biquadLowPass(frequency, resonance, descriptor.rate);
-                    break;
-                case HIGH_PASS_TYPE:
-                    _coeffs = FilterCalculator.biquadHighPass(frequency, resonance, descriptor.rate);
-                    break;
-                case BAND_PASS_TYPE:
-                    _coeffs = FilterCalculator.biquadBandPass(frequency, resonance, descriptor.rate);
-                    break;
-            }
-            _calculated = true;
+            _lastFrequency = _frequency;
+            _lastResonance = _resonance;
+            _lastGain = _gain;
         }
         
         override public function getSample(numFrames:Number):Sample 
         {
-        	var sample:Sample = _source.getSample(numFrames);
-        	
-        	// Make sure our filter coefficients are up to date
-        	computeCoefficients();
+        	var sample:Sample = pullSample(numFrames);
         	
-        	// Run the biquad function on the sample, passing the state buffer and our calculated filter coefficients
-        	sample.biquad(_state, _coeffs);
+        	// Sweep from where the last block left off to the current parameters
+        	sample.biquadSweep(_state, _type, _lastFrequency, _frequency, _lastResonance, _resonance, _lastGain, _gain);
+        	settle();
         	
         	return sample;
         	
@@ -169,7 +176,7 @@ package com.noteflight.standingwave3.filters
 
         override public function clone():IAudioSource
         {
-            return new BiquadFilter(source.clone(), type, frequency, resonance);
+            return new BiquadFilter(source.clone(), type, frequency, resonance, gain);
         }
     }
 }
@@ -27,6 +27,10 @@ package com.noteflight.standingwave3.filters
      * into an IRandomAccessSource.
      * Because allocating the sample memory can be expensive, you can set a max size for a cache
      * and allow it to resize or not.
+     * 
+     * Cache memory is accounted as Sample.MEMORY_CACHE. When a Sample.memoryBudget is set and
+     * an allocation would exceed it, evictable caches are released in least recently used order.
+     * An evicted cache is refilled from its source the next time it is read.
      */
     public class CacheFilter implements IAudioFilter, IRandomAccessSource, IDirectAccessSource
     {
@@ -51,12 +55,52 @@ package com.noteflight.standingwave3.filters
         private var _position:Number;
         private var _source:IAudioSource;
         
+        /** Eviction state, shared with clones since they share the cache */
+        private var _entry:CacheEntry;
+        
+        /** Every live cache, for eviction */
+        private static var _entries:Vector.<CacheEntry> = new Vector.<CacheEntry>();
+        
+        /** Counts cache reads, to order caches by their last use */
+        private static var _clock:Number = 0;
+        
+        private static var _evictionRegistered:Boolean = false;
+        
 
         public function CacheFilter(source:IAudioSource = null)
         {
+        	if (!_evictionRegistered) {
+        		Sample.addEvictionHandler(evictCaches);
+        		_evictionRegistered = true;
+        	}
             this.source = source;
         }
         
+        /**
+         * Whether this cache may be released under memory pressure. Defaults to true.
+         * Caches of sources that are expensive to render again, or cannot be rendered again,
+         * should not be evictable.
+         */
+        public function get evictable():Boolean
+        {
+        	return _entry ? _entry.evictable : true;
+        }
+        
+        public function set evictable(value:Boolean):void
+        {
+        	if (_entry) {
+        		_entry.evictable = value;
+        	}
+        }
+        
+        /**
+         * Whether this cache's memory has been released. It will be refilled when next read.
+         */
+        public function get evicted():Boolean
+        {
+        	return _cache != null && _cache.evicted;
+        }
+        
         /**
          * The underlying audio source for this filter. 
          */
@@ -72,6 +116,7 @@ package com.noteflight.standingwave3.filters
             {
                 resetPosition();                 
                 if (_cache) {
+                	unregister();
                 	_cache.destroy();
                 }
                 if (_source.frameCount >= maxFrameCount) {
@@ -81,6 +126,10 @@ package com.noteflight.standingwave3.filters
                 	// We know how long the source is, and it's small, so we'll make a cache sample exactly the right size
                 	_cache = new Sample(_source.descriptor, _source.frameCount, true);
                 }
+                _cache.memoryCategory = Sample.MEMORY_CACHE;
+                _entry = new CacheEntry(_cache, _source);
+                _entries.push(_entry);
+                touch();
                 
                 // Reset the source's position since we've cached none of it yet
                 _source.resetPosition();
@@ -105,6 +154,7 @@ package com.noteflight.standingwave3.filters
         
         public function getSamplePointer(frameOffset:Number = 0):uint 
         {
+        	touch();
         	if (frameOffset > _source.position) {
         		// We're not giving you a pointer to sample memory we haven't filled yet!
         		// trace("No pointer, source position exceeded");
@@ -181,6 +231,18 @@ package com.noteflight.standingwave3.filters
                 toOffset = source.frameCount;
             }
             
+            // Keep this cache from being evicted by the allocations below
+            touch();
+            _entry.pinned = true;
+            try {
+            	fillCache(toOffset);
+            } finally {
+            	_entry.pinned = false;
+            }
+        }
+        
+        private function fillCache(toOffset:Number):void
+        {
             if (toOffset > _cache.frameCount) { 
             	if (!resizable) {
             		throw new Error("Fill called beyond the bounds of an unresizable CacheFilter");
@@ -224,6 +286,7 @@ package com.noteflight.standingwave3.filters
             var c:CacheFilter = new CacheFilter();
             c._cache = _cache;
             c._source = _source;
+            c._entry = _entry;
             c.resetPosition();
             return c;
         }
@@ -233,8 +296,92 @@ package com.noteflight.standingwave3.filters
         * up its sample memory.
         */
         public function destroy():void {
+        	unregister();
         	_cache.destroy();
         	_cache = null;
         }
+        
+        /**
+         * Marks this cache as just used, refilling it first if it has been evicted.
+         */
+        private function touch():void
+        {
+        	_entry.lastUse = ++_clock;
+        	if (_cache.evicted) {
+        		_entry.pinned = true;
+        		try {
+        			_cache.restore();
+        		} finally {
+        			_entry.pinned = false;
+        		}
+        	}
+        }
+        
+        private function unregister():void
+        {
+        	var i:int = _entries.indexOf(_entry);
+        	if (i >= 0) {
+        		_entries.splice(i, 1);
+        	}
+        }
+        
+        /**
+         * Releases the memory of evictable caches, least recently used first, until at least
+         * the given number of bytes has been freed. Caches that are being filled are skipped.
+         * This is registered as a Sample eviction handler, and may also be called directly.
+         * @return the number of bytes freed
+         */
+        public static function evictCaches(bytes:Number):Number
+        {
+        	var freed:Number = 0;
+        	var candidates:Vector.<CacheEntry> = _entries.filter(isEvictable);
+        	candidates.sort(byLastUse);
+        	for (var i:int = 0; i < candidates.length && freed < bytes; i++) {
+        		freed += candidates[i].evict();
+        	}
+        	return freed;
+        }
+        
+        private static function isEvictable(entry:CacheEntry, index:int, v:Vector.<CacheEntry>):Boolean
+        {
+        	return entry.evictable && !entry.pinned && !entry.cache.evicted;
+        }
+        
+        private static function byLastUse(a:CacheEntry, b:CacheEntry):Number
+        {
+        	return a.lastUse - b.lastUse;
+        }
     }
 }
+
+import com.noteflight.standingwave3.elements.*;
+
+/**
+ * The eviction state of one cache sample, shared by a CacheFilter and its clones.
+ */
+class CacheEntry
+{
+	public var cache:Sample;
+	public var source:IAudioSource;
+	public var lastUse:Number = 0;
+	public var evictable:Boolean = true;
+	public var pinned:Boolean = false;
+	
+	public function CacheEntry(cache:Sample, source:IAudioSource)
+	{
+		this.cache = cache;
+		this.source = source;
+	}
+	
+	/**
+	 * Frees the cache memory and rewinds the source, since none of it is cached any more.
+	 * @return the number of bytes freed
+	 */
+	public function evict():Number
+	{
+		var bytes:Number = cache.frameCount * cache.channels * 4;
+		cache.evict();
+		source.resetPosition();
+		return bytes;
+	}
+}
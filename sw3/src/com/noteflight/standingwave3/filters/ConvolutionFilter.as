@@ -0,0 +1,190 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  NOTEFLIGHT LLC
+//  Copyright 2009 Noteflight LLC
+// 
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+package com.noteflight.standingwave3.filters
+{
+    import com.noteflight.standingwave3.elements.*
+    
+    /**
+     * A ConvolutionFilter convolves its source with an ImpulseResponse, typically to apply
+     * the reverb of a real space. The convolution is done in the frequency domain in blocks,
+     * so long impulses are affordable. 
+     * 
+     * The output, both wet and dry, is delayed by the partition size of the impulse, including
+     * when the filter is bypassed at draft RenderQuality. The filter carries on for the length of
+     * the impulse after its source ends, so the reverb tail is heard.
+     */
+    public class ConvolutionFilter extends AbstractFilter
+    {
+        private var _impulse:ImpulseResponse;
+        private var _wet:Number;
+        private var _dry:Number;
+        
+        /** Pointer to the native convolution state */
+        private var _state:uint = 0;
+        
+        /** Frames rendered since the source ended */
+        private var _tailPosition:Number = 0;
+        
+        /**
+         * Create a new ConvolutionFilter. The wet and dry mix may be changed while the filter is operating.
+         *  
+         * @param source the underlying IAudioSource
+         * @param impulse the prepared impulse response, which may be shared with other filters
+         * @param wet the amount of convolved signal in the output
+         * @param dry the amount of original signal in the output
+         */
+        public function ConvolutionFilter(source:IAudioSource = null, impulse:ImpulseResponse = null, wet:Number = 0.5, dry:Number = 1.0)
+        {
+            _impulse = impulse;
+            super(source);
+            this.essential = false;
+            this.wet = wet;
+            this.dry = dry;
+        }
+        
+        /**
+         * @inheritDoc
+         */
+        override public function resetPosition():void
+        {
+            super.resetPosition();
+            _tailPosition = 0;
+            if (_state) {
+                Sample.resetConvolution(_state);
+            }
+        }
+        
+        /**
+         * The source's frames, then its last frame's delay and reverb tail.
+         */
+        override public function get frameCount():Number
+        {
+            return source.frameCount + latency + _impulse.frameCount - 1;
+        }
+        
+        /**
+         * @inheritDoc
+         */
+        override public function get position():Number
+        {
+            // The source may have been pulled a little past its end, in the block it ended in
+            return Math.min(source.position, source.frameCount) + _tailPosition;
+        }
+        
+        /**
+         * The impulse response this filter convolves with. 
+         */
+        public function get impulse():ImpulseResponse
+        {
+            return _impulse;
+        }
+        
+        /**
+         * The amount of convolved signal in the output.
+         */
+        public function get wet():Number
+        {
+            return _wet;
+        }
+        
+        public function set wet(value:Number):void
+        {
+            _wet = value;
+        }
+        
+        /**
+         * The amount of original signal in the output.
+         */
+        public function get dry():Number
+        {
+            return _dry;
+        }
+        
+        public function set dry(value:Number):void
+        {
+            _dry = value;
+        }
+        
+        /**
+         * The number of frames by which the output lags the source. 
+         */
+        public function get latency():Number
+        {
+            return _impulse.partitionSize;
+        }
+        
+        override public function getSample(numFrames:Number):Sample 
+        {
+            if (_state == 0)
+            {
+                _state = _impulse.allocateConvolution(descriptor.channels);
+            }
+            
+            // Past the end of the source, the filter is fed silence
+            var sourceFrames:Number = Math.max(0, Math.min(numFrames, source.frameCount - source.position));
+            var sample:Sample;
+            if (sourceFrames > 0) {
+                sample = pullSample(numFrames);
+                if (sourceFrames < numFrames) {
+                    sample.setSamples(0, sourceFrames, numFrames - sourceFrames);
+                }
+            } else {
+                sample = silentSample(numFrames);
+            }
+            _tailPosition += numFrames - sourceFrames;
+            
+            if (bypassed)
+            {
+                // Pass just the dry signal, still delayed, so the timing doesn't move with the quality
+                sample.convolveDry(_state, _dry);
+            }
+            else
+            {
+                sample.convolve(_state, _dry, _wet);
+            }
+            return sample;   
+        }
+        
+        override public function clone():IAudioSource
+        {
+            var filter:ConvolutionFilter = new ConvolutionFilter(source.clone(), impulse, wet, dry);
+            filter.essential = essential;
+            return filter;
+        }
+        
+        /**
+         * Free the convolution state along with the source's, until the next render needs it again.
+         */
+        override public function releaseState():void
+        {
+            super.releaseState();
+            destroy();
+        }
+        
+        /**
+        * Destroy ConvolutionFilters to free the convolution state.
+        * The impulse response is not destroyed, since it may be shared.
+        */
+        public function destroy():void 
+        {
+            if (_state) {
+                Sample.deallocateConvolution(_state);
+                _state = 0;
+            }
+        }
+    }
+}
@@ -18,12 +18,14 @@ package com.noteflight.standingwave3.filters
 {
     import com.noteflight.standingwave3.elements.*;
     import com.noteflight.standingwave3.modulation.Mod;
+    import com.noteflight.standingwave3.utils.AudioUtils;
     
     /**
      * DecayFilter passes the signal unchanged until the fade is reached,
      * and then fades it out with the supplied envelope.
+     * Over a direct access source, the fade is a gain ramp that a mixer can apply while mixing. 
      */
-    public class DecayFilter extends AbstractFilter implements IDirectAccessSource
+    public class DecayFilter extends AbstractFilter implements IGainRampSource
     {
     
         public static const MIN_SIGNAL:Number = -50; //db
@@ -34,6 +36,12 @@ package com.noteflight.standingwave3.filters
  		/** Fade time in frames */
  		private var _fadeDuration:Number;
  		
+ 		/** The ramp returned by getGainRamp(), reused from call to call */
+ 		private var _ramp:Object = { start:1, end:1, curve:Sample.RAMP_EXPONENTIAL };
+ 		
+ 		/** The envelope segment applied by getSample(), reused from block to block */
+ 		private var _envelope:Mod = new Mod();
+ 		
         /**
          * Create a new DecayFilter. 
          * @param source the underlying audio source
@@ -130,9 +138,9 @@ package com.noteflight.standingwave3.filters
             var startPosition:Number = _source.position;
             var framesToFade:Number;
             var sampleStartPosition:Number;
-            var sample:Sample = _source.getSample(numFrames);
+            var sample:Sample = pullSample(numFrames);
             var endPosition:Number = _source.position;
-            var mp:Mod = new Mod(); // our decay envelope segment
+            var mp:Mod = _envelope; // our decay envelope segment
             
             if (_source.position > _fadeStart) {
             	// we need to fade some of this sample
@@ -191,6 +199,23 @@ package com.noteflight.standingwave3.filters
 			}
 		}
 
+		/**
+		 * The fade is linear in decibels, so each block of it is a single exponential ramp.
+		 * Blocks that straddle the fade start are not, and are rendered by getSample().
+		 */
+		public function get unscaledSource():IDirectAccessSource {
+			return _source as IDirectAccessSource;
+		}
+		
+		public function getGainRamp(offset:Number, numFrames:Number):Object {
+			if (offset < _fadeStart) {
+				return null;
+			}
+			_ramp.start = AudioUtils.decibelsToFactor(fadeGainAtPosition(offset));
+			_ramp.end = AudioUtils.decibelsToFactor(fadeGainAtPosition(offset + numFrames));
+			return _ramp;
+		}
+
 		/**
 		 * Cloning the filter also clones the source
 		 */
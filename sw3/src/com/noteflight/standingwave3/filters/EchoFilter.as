@@ -44,6 +44,7 @@ package com.noteflight.standingwave3.filters
         public function EchoFilter(source:IAudioSource = null, period:Number = 0, wet:Number = 0.5, decay:Number = 0.5)
         {
             super(source);
+            this.essential = false;
             this.period = period;
             this.wet = wet;
             this.decay = decay;
@@ -108,14 +109,18 @@ package com.noteflight.standingwave3.filters
         
         override public function getSample(numFrames:Number):Sample 
         {
+        	if (bypassed) {
+        		return pullSample(numFrames); // the dry signal is mixed at unity
+        	}
         	// The delay line is just a Sample whose channels are used as a ring buffer.
             if (_ring == null)
             {
                 _bufferLength = Math.floor(_period * _source.descriptor.rate );
                 _ring = new Sample(descriptor, _bufferLength);
+                _ring.memoryCategory = Sample.MEMORY_SCRATCH;
             }
             
-            var sample:Sample = _source.getSample(numFrames); 
+            var sample:Sample = pullSample(numFrames); 
             sample.delay(_ring, 1.0, _wet, _decay);  
             
             return sample;   
@@ -123,7 +128,9 @@ package com.noteflight.standingwave3.filters
         
         override public function clone():IAudioSource
         {
-            return new EchoFilter(source.clone(), period, wet, decay);
+            var filter:EchoFilter = new EchoFilter(source.clone(), period, wet, decay);
+            filter.essential = essential;
+            return filter;
         }
         
         /**
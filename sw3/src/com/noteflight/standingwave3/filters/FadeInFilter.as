@@ -19,13 +19,15 @@ package com.noteflight.standingwave3.filters
     import com.noteflight.standingwave3.elements.*;
     import com.noteflight.standingwave3.modulation.*;
     import com.noteflight.standingwave3.filters.AbstractFilter;
+    import com.noteflight.standingwave3.utils.AudioUtils;
     
     /**
      * FadeInFilter passes the signal unchanged after fading it in.
      * Many times a fade can be used in place of an Envelope + AmpFilter
      * and will be much more efficient, since it only calculates during the fading part.
+     * Over a direct access source, the fade is a gain ramp that a mixer can apply while mixing. 
      */
-    public class FadeInFilter extends AbstractFilter
+    public class FadeInFilter extends AbstractFilter implements IGainRampSource
     {
     
         public static const MIN_SIGNAL:Number = -60; //db
@@ -33,6 +35,12 @@ package com.noteflight.standingwave3.filters
  		/** Fade time in frames */
  		private var _fadeDuration:Number;
  		
+ 		/** The ramp returned by getGainRamp(), reused from call to call */
+ 		private var _ramp:Object = { start:1, end:1, curve:Sample.RAMP_EXPONENTIAL };
+ 		
+ 		/** The envelope segment applied by getSample(), reused from block to block */
+ 		private var _envelope:Mod = new Mod();
+ 		
         /**
          * Create a new FadeInFilter. 
          * @param source the underlying audio source
@@ -79,10 +87,10 @@ package com.noteflight.standingwave3.filters
         {
         	var startPosition:Number = _source.position;    
         	var previousStartPosition:Number = startPosition - numFrames;
-            var sample:Sample = _source.getSample(numFrames);
+            var sample:Sample = pullSample(numFrames);
             var endPosition:Number = _source.position;
             var nextEndPosition:Number = endPosition + numFrames;
-            var mp:Mod = new Mod(); // our modulation point for the spline segment
+            var mp:Mod = _envelope; // our modulation point for the spline segment
             
             if (startPosition < _fadeDuration) {
             	// Calculate the four spline points
@@ -100,6 +108,46 @@ package com.noteflight.standingwave3.filters
             return sample;
         }
 
+		/* As in DecayFilter, the filter acts as an IDirectAccessSource whenever its source is one. */
+		
+		public function fill(toOffset:Number=-1):void {
+			if (_source is IDirectAccessSource) {
+				IDirectAccessSource(_source).fill(toOffset);
+			}
+		}
+		
+		public function useSample(numFrames:Number):void {
+			if (_source is IDirectAccessSource) {
+				IDirectAccessSource(_source).useSample(numFrames);
+			}
+		}
+		
+		public function getSamplePointer(offset:Number=0):uint {
+			// Return a null sample pointer while any of the fade is still to be read,
+			// so that a mixer has to pick up the fade through getGainRamp() or getSample()
+			if (!(_source is IDirectAccessSource) || _source.position < _fadeDuration || offset < _fadeDuration) {
+				return 0;
+			}
+			return IDirectAccessSource(_source).getSamplePointer(offset);
+		}
+		
+		/**
+		 * The fade is linear in decibels, so each block of it is a single exponential ramp.
+		 * Blocks that straddle the fade end are not, and are rendered by getSample().
+		 */
+		public function get unscaledSource():IDirectAccessSource {
+			return _source as IDirectAccessSource;
+		}
+		
+		public function getGainRamp(offset:Number, numFrames:Number):Object {
+			if (offset + numFrames > _fadeDuration) {
+				return null;
+			}
+			_ramp.start = AudioUtils.decibelsToFactor(fadeGainAtPosition(offset));
+			_ramp.end = AudioUtils.decibelsToFactor(fadeGainAtPosition(offset + numFrames));
+			return _ramp;
+		}
+
         override public function clone():IAudioSource
         {
             return new FadeInFilter(_source.clone(), _fadeDuration);
@@ -97,7 +97,7 @@ package com.noteflight.standingwave3.filters
             var framesToFade:Number;
             var sampleStartPosition:Number;
             
-            var sample:Sample = _source.getSample(numFrames);
+            var sample:Sample = pullSample(numFrames);
             
             if (_source.position > _fadeStart) {
             	// we need to fade some of this sample
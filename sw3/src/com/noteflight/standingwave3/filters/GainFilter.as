@@ -43,7 +43,7 @@ package com.noteflight.standingwave3.filters
                 
         override public function getSample(numFrames:Number):Sample
         {
-            var sample:Sample = _source.getSample(numFrames);
+            var sample:Sample = pullSample(numFrames);
             var fgain:Number = AudioUtils.decibelsToFactor(gain);
            	sample.changeGain(fgain);
             return sample;
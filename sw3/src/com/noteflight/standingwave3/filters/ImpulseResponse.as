@@ -0,0 +1,101 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  NOTEFLIGHT LLC
+//  Copyright 2009 Noteflight LLC
+// 
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+package com.noteflight.standingwave3.filters
+{
+    import com.noteflight.standingwave3.elements.*
+    
+    /**
+     * An ImpulseResponse is an impulse sample that has been prepared for use by ConvolutionFilters.
+     * Preparing an impulse transforms it into the frequency domain once, so a single ImpulseResponse
+     * should be shared by every filter that uses the same impulse.
+     */
+    public class ImpulseResponse
+    {
+        /** Pointer to the native prepared impulse */
+        private var _pointer:uint;
+        
+        private var _partitionSize:int;
+        private var _channels:Number;
+        private var _frameCount:Number;
+        
+        /**
+         * Prepare an impulse response. The sample is no longer needed once this returns, and may be destroyed.
+         *  
+         * @param sample the impulse, mono or stereo
+         * @param partitionSize the block size of the convolution, a power of two. Larger partitions are
+         * cheaper to run, but add latency.
+         * @throws Error if the impulse could not be prepared, such as for a bad partition size
+         */
+        public function ImpulseResponse(sample:Sample, partitionSize:int = 1024)
+        {
+            _partitionSize = partitionSize;
+            _channels = sample.channels;
+            _frameCount = sample.frameCount;
+            _pointer = sample.prepareConvolutionImpulse(partitionSize);
+            if (_pointer == 0) {
+                throw new Error("Unable to prepare an impulse response of partition size " + partitionSize);
+            }
+        }
+        
+        /**
+         * The block size of the convolution in frames. This is also its latency.
+         */
+        public function get partitionSize():int
+        {
+            return _partitionSize;
+        }
+        
+        /**
+         * The number of channels in the impulse.
+         */
+        public function get channels():Number
+        {
+            return _channels;
+        }
+        
+        /**
+         * The length of the impulse in frames.
+         */
+        public function get frameCount():Number
+        {
+            return _frameCount;
+        }
+        
+        /**
+         * Allocate a convolution state using this impulse. Called by ConvolutionFilter.
+         */
+        public function allocateConvolution(channels:Number):uint
+        {
+            if (_pointer == 0) {
+                throw new Error("ImpulseResponse has been destroyed");
+            }
+            return Sample.allocateConvolution(_pointer, channels);
+        }
+        
+        /**
+        * Release this impulse response. Its memory is freed once every filter using it
+        * has also been destroyed.
+        */
+        public function destroy():void
+        {
+            if (_pointer) {
+                Sample.releaseConvolutionImpulse(_pointer);
+                _pointer = 0;
+            }
+        }
+    }
+}
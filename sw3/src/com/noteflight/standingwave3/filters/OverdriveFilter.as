@@ -20,39 +20,160 @@ package com.noteflight.standingwave3.filters
     import com.noteflight.standingwave3.utils.AudioUtils;
     
     /**
-     * GainFilter applies a fixed gain factor to the underlying source.
-     * This is about as simple a filter as it is possible to make, and runs fast.
-     * In practice, it's not common to use this filter, as gain changes can
-     * be snuck into many other filters as well.
+     * OverdriveFilter boosts its source by a gain and then runs it through a saturating curve,
+     * either the soft tangent-shaped overdrive curve or a hard clip.
+     * 
+     * Both curves generate harmonics well above the signal, which alias back down when the curve
+     * is run at the sample rate. For cleaner distortion, the curve may be run at 2x or 4x oversampling.
+     * The oversampling filters delay the signal by a few frames, which is made up by running the
+     * shaper ahead over the start of the source, so the output stays in time at any RenderQuality.
      */
     public class OverdriveFilter extends AbstractFilter
     {
-        /** The gain factor applied, in decibels */
+        /** The soft, tangent-shaped saturation curve */
+        public static const SOFT:int = 0;
+        
+        /** A hard clip at full scale */
+        public static const HARD:int = 1;
+        
+        /** The gain factor applied before the curve, in decibels */
         public var gain:Number;
         
+        private var _oversample:int;
+        private var _curve:int;
+        
+        /** Pointer to the native shaper, when oversampling */
+        private var _shaper:uint = 0;
+        
+        /** Whether the shaper has run ahead of the output since it was last started, by prime() */
+        private var _primed:Boolean = false;
+        
         /**
-         * Create a new GainFilter. 
+         * Create a new OverdriveFilter. 
          * @param source the underlying audio source
-         * @param gain the gain factor
+         * @param gain the gain applied before the curve, in decibels
+         * @param oversample the oversampling factor for the curve, 1, 2 or 4
+         * @param curve the curve to apply, SOFT or HARD
          */
-        public function OverdriveFilter(source:IAudioSource, gain:Number=0)
+        public function OverdriveFilter(source:IAudioSource, gain:Number=0, oversample:int=1, curve:int=SOFT)
         {
+            _oversample = oversample;
+            _curve = curve;
             super(source);
             this.gain = gain;
         }
+        
+        /**
+         * @inheritDoc
+         */
+        override public function resetPosition():void
+        {
+            super.resetPosition();
+            _primed = false;
+        }
+        
+        /**
+         * The oversampling factor for the curve. 
+         */
+        public function get oversample():int
+        {
+            return _oversample;
+        }
+        
+        /**
+         * The curve applied, SOFT or HARD. 
+         */
+        public function get curve():int
+        {
+            return _curve;
+        }
+        
+        /**
+         * The number of frames by which the output lags the source. The whole frames of the
+         * oversampling delay are compensated, so this is only the fraction of a frame left over.
+         */
+        public function get latency():Number
+        {
+            return oversampling ? Sample.shaperLatency(shaper) % 1 : 0;
+        }
+        
+        /** Oversampling is skipped at draft RenderQuality */
+        private function get oversampling():Boolean
+        {
+            return _oversample > 1 && !RenderQuality.draft;
+        }
+        
+        /** The native shaper, allocated on first use */
+        private function get shaper():uint
+        {
+            if (_shaper == 0) {
+                _shaper = Sample.allocateShaper(_curve, descriptor.channels, _oversample);
+            }
+            return _shaper;
+        }
                 
         override public function getSample(numFrames:Number):Sample
         {
-            var sample:Sample = _source.getSample(numFrames);
             var fgain:Number = AudioUtils.decibelsToFactor(gain);
+            if (!oversampling) {
+                // Coming back to oversampling starts the shaper afresh, rather than from stale history
+                _primed = false;
+            } else if (!_primed) {
+                prime(fgain);
+            }
+            var sample:Sample = pullSample(numFrames);
            	sample.changeGain(fgain);
-           	sample.overdrive();
+           	if (oversampling) {
+           	    sample.shape(shaper);
+           	} else if (_curve == HARD) {
+           	    sample.clip();
+           	} else {
+           	    sample.overdrive();
+           	}
             return sample;
         }
+        
+        /**
+         * Start the shaper afresh and run it over as many frames of the source as it delays them,
+         * discarding its output, so that what follows lines up with the source.
+         */
+        private function prime(fgain:Number):void
+        {
+            Sample.resetShaper(shaper);
+            var frames:int = Math.floor(Sample.shaperLatency(shaper));
+            if (frames > 0) {
+                var lead:Sample = source.getSample(frames);
+                lead.changeGain(fgain);
+                lead.shape(shaper);
+                lead.destroy();
+            }
+            _primed = true;
+        }
 
         override public function clone():IAudioSource
         {
-            return new OverdriveFilter(source.clone(), gain);
+            return new OverdriveFilter(source.clone(), gain, oversample, curve);
+        }
+        
+        /**
+         * Free the native shaper along with the source's state, until the next render needs it again.
+         */
+        override public function releaseState():void
+        {
+            super.releaseState();
+            destroy();
+        }
+        
+        /**
+        * Destroy oversampling OverdriveFilters to free the native shaper.
+        */
+        public function destroy():void 
+        {
+            if (_shaper) {
+                Sample.deallocateShaper(_shaper);
+                _shaper = 0;
+            }
+            _primed = false;
         }
     }
 }
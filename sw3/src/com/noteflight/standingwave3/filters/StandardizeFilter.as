@@ -66,6 +66,12 @@ package com.noteflight.standingwave3.filters
         	} else if (source.descriptor.rate == AudioDescriptor.RATE_22050) {
         		sample = _source.getSample(Math.floor(numFrames/2));
         	}
+        	if (sample.borrowed && !AudioDescriptor.compare(sample.descriptor, _descriptor)) {
+        		// Standardize a copy, leaving the source's own block as it was
+        		var copy:Sample = new Sample(sample.descriptor, sample.frameCount, false);
+        		copy.copy(sample, 0);
+        		sample = copy;
+        	}
            	sample.standardize();
             return sample;
         }
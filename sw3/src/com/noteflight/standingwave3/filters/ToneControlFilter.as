@@ -18,7 +18,6 @@ package com.noteflight.standingwave3.filters
 {
 	import com.noteflight.standingwave3.elements.*;
 	import com.noteflight.standingwave3.filters.AbstractFilter;
-	import com.noteflight.standingwave3.utils.*;
 
 	/**
 	 * ToneControlFilter provides relatively basic and gentle equalization
@@ -46,33 +45,43 @@ package com.noteflight.standingwave3.filters
 		private var _bassState:Sample;
 		private var _trebleState:Sample;
 		
+		// Settings at the end of the last block, so changes sweep smoothly into the next one
+		private var _lastBass:Number = 0;
+		private var _lastTreble:Number = 0;
+		private var _lastBassFrequency:Number = 120;
+		private var _lastTrebleFrequency:Number = 8000;
+		
 		public function ToneControlFilter(source:IAudioSource=null)
 		{
 			super(source);
 			_bassState = new Sample(descriptor, 4);
 			_trebleState = new Sample(descriptor, 4);
+			_bassState.memoryCategory = Sample.MEMORY_SCRATCH;
+			_trebleState.memoryCategory = Sample.MEMORY_SCRATCH;
+		}
+		
+		override public function resetPosition():void
+		{
+			super.resetPosition();
+			_lastBass = bass;
+			_lastTreble = treble;
+			_lastBassFrequency = bassFrequency;
+			_lastTrebleFrequency = trebleFrequency;
 		}
 		
 	 	override public function getSample(numFrames:Number):Sample
 	 	{
-	 		var bassCoeffs:Object; 
-	 		var trebleCoeffs:Object; 
+	 		var bassType:int = (bassShape == PEAK) ? BiquadFilter.PEAK_TYPE : BiquadFilter.LOW_SHELF_TYPE;
+	 		var trebleType:int = (trebleShape == PEAK) ? BiquadFilter.PEAK_TYPE : BiquadFilter.HIGH_SHELF_TYPE;
 	 	
-	 		if (bassShape == PEAK) {
-	 			bassCoeffs = FilterCalculator.biquadPeakEQ(bassFrequency, 3, bass, _source.descriptor.rate);
-	 		} else {
-	 			bassCoeffs = FilterCalculator.biquadLowShelfEQ(bassFrequency, 3, bass, _source.descriptor.rate);
-	 		}   
+	 		var sample:Sample = pullSample(numFrames);
+	 		sample.biquadSweep(_bassState, bassType, _lastBassFrequency, bassFrequency, 3, 3, _lastBass, bass);
+	 		sample.biquadSweep(_trebleState, trebleType, _lastTrebleFrequency, trebleFrequency, 3, 3, _lastTreble, treble);
 	 		
-	 		if (trebleShape == PEAK) {
-	 			trebleCoeffs = FilterCalculator.biquadPeakEQ(trebleFrequency, 3, treble, _source.descriptor.rate);
-	 		} else {
-	 			trebleCoeffs = FilterCalculator.biquadHighShelfEQ(trebleFrequency, 3, treble, _source.descriptor.rate);
-	 		}
-	 	
-	 		var sample:Sample = _source.getSample(numFrames);
-	 		sample.biquad(_bassState, bassCoeffs);
-	 		sample.biquad(_trebleState, trebleCoeffs);
+	 		_lastBass = bass;
+	 		_lastTreble = treble;
+	 		_lastBassFrequency = bassFrequency;
+	 		_lastTrebleFrequency = trebleFrequency;
 	 		
 	 		return sample;
 	 	}
@@ -0,0 +1,271 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  NOTEFLIGHT LLC
+//  Copyright 2009 Noteflight LLC
+// 
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+package com.noteflight.standingwave3.formats
+{
+    import __AS3__.vec.Vector;
+    
+    import com.noteflight.instruments.SamplerSource;
+    import com.noteflight.standingwave3.elements.*;
+    
+    import flash.utils.ByteArray;
+    import flash.utils.Endian;
+    
+    /**
+     * A SampleBank holds the sample zones of an instrument, packed with their loop points and
+     * note ranges into a single block. Loading a bank is one copy into sample memory, with no
+     * parsing or conversion of audio, and its zones are shared by every SamplerSource that plays them.
+     * 
+     * <p>Zones of FLOAT banks are played straight from the bank's memory. Zones of SHORT banks
+     * take half the memory, and are each decoded into their own Sample when first played. Decoded
+     * zones may be evicted under memory pressure, and are decoded again when next played.</p>
+     * 
+     * <p>The layout is little endian: a 16 byte header of "SWBK", the version and the zone count,
+     * then a 64 byte table entry for each zone, then the zone data, each aligned to 16 bytes.
+     * The same layout is read in place by the awaveBank functions of libawave.</p>
+     */
+    public class SampleBank
+    {
+        /** Zone formats, matching the AWAVE_BANK_ constants in libawave */
+        public static const FLOAT:int = 0;
+        public static const SHORT:int = 1;
+        
+        private static const MAGIC:String = "SWBK";
+        private static const VERSION:int = 1;
+        private static const HEADER_BYTES:int = 16;
+        private static const ZONE_BYTES:int = 64;
+        internal static const NAME_BYTES:int = 16;
+        private static const ALIGNMENT:int = 16;
+        
+        /** Pointer to the bank in sample memory */
+        private var _bank:uint;
+        
+        private var _zones:Vector.<SampleBankZone> = new Vector.<SampleBankZone>();
+        
+        /** Every live bank, for eviction */
+        private static var _banks:Vector.<SampleBank> = new Vector.<SampleBank>();
+        
+        /** Counts zone reads, to order decoded zones by their last use */
+        private static var _clock:Number = 0;
+        
+        private static var _evictionRegistered:Boolean = false;
+        
+        /**
+         * Load a bank. The ByteArray is not kept, and may be discarded once the bank is constructed. 
+         * @param bytes a bank as written by write()
+         */
+        public function SampleBank(bytes:ByteArray)
+        {
+        	if (!_evictionRegistered) {
+        		Sample.addEvictionHandler(evictZones);
+        		_evictionRegistered = true;
+        	}
+        	
+        	// The bank is checked natively as it is loaded, so the table can be read without further checks
+        	_bank = Sample.allocateBank(bytes);
+        	var endian:String = bytes.endian;
+        	var position:uint = bytes.position;
+        	bytes.endian = Endian.LITTLE_ENDIAN;
+        	bytes.position = 8;
+        	var count:int = bytes.readInt();
+        	for (var i:int = 0; i < count; i++) {
+        		bytes.position = HEADER_BYTES + i * ZONE_BYTES;
+        		_zones.push(new SampleBankZone(this, i, bytes));
+        	}
+        	bytes.endian = endian;
+        	bytes.position = position;
+        	_banks.push(this);
+        }
+        
+        /**
+         * The zones of this bank, in the order they were written.
+         */
+        public function get zones():Vector.<SampleBankZone>
+        {
+        	return _zones;
+        }
+        
+        /**
+         * The first zone with this name, or null.
+         */
+        public function getZone(name:String):SampleBankZone
+        {
+        	for each (var zone:SampleBankZone in _zones) {
+        		if (zone.name == name) {
+        			return zone;
+        		}
+        	}
+        	return null;
+        }
+        
+        /**
+         * The first zone whose note range includes a MIDI note, or null.
+         */
+        public function getZoneForNote(note:int):SampleBankZone
+        {
+        	for each (var zone:SampleBankZone in _zones) {
+        		if (note >= zone.lowNote && note <= zone.highNote) {
+        			return zone;
+        		}
+        	}
+        	return null;
+        }
+        
+        /**
+         * Create a SamplerSource that plays a MIDI note from the zone covering it, with the zone's
+         * loop points, shifted from the zone's root note.
+         * @return the sampler, or null if no zone covers the note
+         */
+        public function createSampler(note:int, ad:AudioDescriptor = null):SamplerSource
+        {
+        	var zone:SampleBankZone = getZoneForNote(note);
+        	if (!zone) {
+        		return null;
+        	}
+        	var sampler:SamplerSource = new SamplerSource(ad ? ad : new AudioDescriptor(), zone);
+        	sampler.startFrame = zone.startFrame;
+        	sampler.endFrame = zone.endFrame;
+        	sampler.firstFrame = zone.firstFrame;
+        	sampler.frequencyShift = Math.pow(2, (note - zone.rootNote) / 12);
+        	return sampler;
+        }
+        
+        /**
+         * Pointer to the bank in sample memory, for its zones.
+         */
+        internal function get pointer():uint
+        {
+        	return _bank;
+        }
+        
+        /**
+         * Marks a zone as just used, for eviction order.
+         */
+        internal static function tick():Number
+        {
+        	return ++_clock;
+        }
+        
+        /**
+         * Frees the bank and its decoded zones. None of its zones may be played afterwards.
+         */
+        public function destroy():void
+        {
+        	for each (var zone:SampleBankZone in _zones) {
+        		zone.destroy();
+        	}
+        	if (_bank) {
+        		Sample.deallocateBank(_bank);
+        		_bank = 0;
+        	}
+        	var i:int = _banks.indexOf(this);
+        	if (i >= 0) {
+        		_banks.splice(i, 1);
+        	}
+        }
+        
+        /**
+         * Eviction handler that releases decoded zones of SHORT banks, least recently played first.
+         * Zones of FLOAT banks are the bank memory itself, and are released only by destroy().
+         */
+        public static function evictZones(bytes:Number):Number
+        {
+        	var candidates:Vector.<SampleBankZone> = new Vector.<SampleBankZone>();
+        	for each (var bank:SampleBank in _banks) {
+        		for each (var zone:SampleBankZone in bank._zones) {
+        			if (zone.decoded) {
+        				candidates.push(zone);
+        			}
+        		}
+        	}
+        	candidates.sort(byLastUse);
+        	var freed:Number = 0;
+        	for (var i:int = 0; i < candidates.length && freed < bytes; i++) {
+        		freed += candidates[i].evict();
+        	}
+        	return freed;
+        }
+        
+        private static function byLastUse(a:SampleBankZone, b:SampleBankZone):Number
+        {
+        	return a.lastUse - b.lastUse;
+        }
+        
+        /**
+         * Pack zones into a bank. Each zone is given as an Object with a sample, and optionally
+         * a name, loop points startFrame, endFrame and firstFrame, and rootNote, lowNote and highNote.
+         * Samples are stored as they are, so standardize them first if they are to be played
+         * without conversion.
+         * 
+         * @param zones an Array of zone Objects
+         * @param format FLOAT, or SHORT for 16 bit zones
+         * @throws Error if a zone's sample is empty, which a bank cannot hold
+         * @returns a ByteArray holding the bank
+         */
+        public static function write(zones:Array, format:int = FLOAT):ByteArray
+        {
+        	var bytes:ByteArray = new ByteArray();
+        	bytes.endian = Endian.LITTLE_ENDIAN;
+        	bytes.writeUTFBytes(MAGIC);
+        	bytes.writeInt(VERSION);
+        	bytes.writeInt(zones.length);
+        	bytes.writeInt(0);
+        	
+        	var offset:int = HEADER_BYTES + zones.length * ZONE_BYTES;
+        	for each (var zone:Object in zones) {
+        		var sample:Sample = zone.sample;
+        		if (sample.frameCount < 1) {
+        			throw new Error("Sample bank zones need at least one frame");
+        		}
+        		var size:int = sample.frameCount * sample.channels * (format == SHORT ? 2 : 4);
+        		var name:ByteArray = new ByteArray();
+        		name.writeUTFBytes(zone.name ? zone.name : "");
+        		name.length = NAME_BYTES;
+        		bytes.writeBytes(name);
+        		bytes.writeInt(sample.descriptor.rate);
+        		bytes.writeInt(sample.channels);
+        		bytes.writeInt(sample.frameCount);
+        		bytes.writeInt(format);
+        		bytes.writeInt(zone.startFrame ? zone.startFrame : 0);
+        		bytes.writeInt(zone.endFrame ? zone.endFrame : 0);
+        		bytes.writeInt(zone.firstFrame ? zone.firstFrame : 0);
+        		bytes.writeInt(zone.rootNote != undefined ? zone.rootNote : 60);
+        		bytes.writeInt(zone.lowNote != undefined ? zone.lowNote : 0);
+        		bytes.writeInt(zone.highNote != undefined ? zone.highNote : 127);
+        		bytes.writeInt(offset);
+        		bytes.writeInt(size);
+        		offset = align(offset + size);
+        	}
+        	
+        	for each (zone in zones) {
+        		bytes.length = align(bytes.length);
+        		bytes.position = bytes.length;
+        		if (format == SHORT) {
+        			zone.sample.writeWavBytes(bytes);
+        		} else {
+        			zone.sample.writeBytes(bytes);
+        		}
+        	}
+        	bytes.position = 0;
+        	return bytes;
+        }
+        
+        private static function align(offset:int):int
+        {
+        	return Math.ceil(offset / ALIGNMENT) * ALIGNMENT;
+        }
+    }
+}
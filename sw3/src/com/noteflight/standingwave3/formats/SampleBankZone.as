@@ -0,0 +1,169 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  NOTEFLIGHT LLC
+//  Copyright 2009 Noteflight LLC
+// 
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+package com.noteflight.standingwave3.formats
+{
+    import com.noteflight.standingwave3.elements.*;
+    
+    import flash.utils.ByteArray;
+    
+    /**
+     * A SampleBankZone is one sample of a SampleBank, with its loop points and note range.
+     * It serves as the generator of any number of SamplerSources at once, since it holds no
+     * playback position of its own.
+     */
+    public class SampleBankZone implements IRandomAccessSource, IDirectAccessSource
+    {
+        public var name:String;
+        
+        /** Loop points and initial start point, in the form taken by SamplerSource */
+        public var startFrame:Number;
+        public var endFrame:Number;
+        public var firstFrame:Number;
+        
+        /** The MIDI note recorded, and the range of notes this zone plays */
+        public var rootNote:int;
+        public var lowNote:int;
+        public var highNote:int;
+        
+        private var _bank:SampleBank;
+        private var _index:int;
+        private var _descriptor:AudioDescriptor;
+        private var _frames:Number;
+        private var _format:int;
+        
+        /** Bytes from the start of the bank to the zone data */
+        private var _offset:int;
+        
+        /** The decoded zone, for SHORT zones only */
+        private var _sample:Sample;
+        
+        private var _lastUse:Number = 0;
+        
+        /**
+         * Read a zone from its entry in a bank's zone table.
+         * @param bytes the bank, positioned at the entry
+         */
+        public function SampleBankZone(bank:SampleBank, index:int, bytes:ByteArray)
+        {
+        	_bank = bank;
+        	_index = index;
+        	name = bytes.readUTFBytes(SampleBank.NAME_BYTES).split(String.fromCharCode(0))[0];
+        	var rate:int = bytes.readInt();
+        	var channels:int = bytes.readInt();
+        	_descriptor = new AudioDescriptor(rate, channels);
+        	_frames = bytes.readInt();
+        	_format = bytes.readInt();
+        	startFrame = bytes.readInt();
+        	endFrame = bytes.readInt();
+        	firstFrame = bytes.readInt();
+        	rootNote = bytes.readInt();
+        	lowNote = bytes.readInt();
+        	highNote = bytes.readInt();
+        	_offset = bytes.readInt();
+        }
+        
+        public function get frameCount():Number {
+        	return _frames;
+        }
+        
+        public function get descriptor():AudioDescriptor {
+        	return _descriptor;
+        }
+        
+        /** SampleBank.FLOAT or SampleBank.SHORT */
+        public function get format():int {
+        	return _format;
+        }
+        
+        /** True if this zone has been decoded into memory of its own, and not evicted since */
+        public function get decoded():Boolean {
+        	return _sample != null && !_sample.evicted;
+        }
+        
+        internal function get lastUse():Number {
+        	return _lastUse;
+        }
+        
+        public function getSampleRange(fromOffset:Number, toOffset:Number):Sample {
+        	var resultSample:Sample = new Sample(_descriptor, toOffset - fromOffset);
+        	toOffset = Math.min(toOffset, frameCount);  // clip to zone length
+        	resultSample.mixInDirectAccessSource(this, fromOffset, 1.0, 0, toOffset - fromOffset);
+        	return resultSample;
+        }
+        
+        public function getSamplePointer(frameOffset:Number = 0):uint 
+        {
+        	fill();
+        	if (_format == SampleBank.FLOAT) {
+        		return _bank.pointer + _offset + frameOffset * _descriptor.channels * 4;
+        	} else {
+        		return _sample.getSamplePointer(frameOffset);
+        	}
+        }
+        
+        /**
+         * The whole zone is always available, so there is nothing to do beyond filling.
+         */
+        public function useSample(numFrames:Number):void
+        {
+        	fill();
+        }
+        
+        /**
+         * Decode the zone if it is a SHORT zone that has not been decoded, or has been evicted.
+         * The whole zone is decoded at once, whatever the offset.
+         */
+        public function fill(toOffset:Number = -1):void
+        {
+        	_lastUse = SampleBank.tick();
+        	if (_format == SampleBank.FLOAT || decoded) {
+        		return;
+        	}
+        	if (_sample) {
+        		_sample.restore();
+        	} else {
+        		_sample = new Sample(_descriptor, _frames, false);
+        		_sample.memoryCategory = Sample.MEMORY_CACHE;
+        	}
+        	_sample.decodeBankZone(_bank.pointer, _index);
+        }
+        
+        /**
+         * Release the decoded zone. It is decoded again when next played.
+         * @return the number of bytes freed
+         */
+        public function evict():Number
+        {
+        	if (!decoded) {
+        		return 0;
+        	}
+        	_sample.evict();
+        	return _frames * _descriptor.channels * 4;
+        }
+        
+        /**
+         * Called by the bank when it is destroyed.
+         */
+        internal function destroy():void
+        {
+        	if (_sample) {
+        		_sample.destroy();
+        		_sample = null;
+        	}
+        }
+    }
+}
@@ -5,14 +5,26 @@ package com.noteflight.standingwave3.modulation
     
     import com.noteflight.standingwave3.elements.*;
     
-    /** The base class for concrete modulation data. */
+    /** 
+     * The base class for concrete modulation data.
+     * Keyframes are kept in order of position, and mirrored into a native curve that voices
+     * evaluate through a ModulationCursor. Change data by adding keyframes, not by editing them in place. 
+     * Call destroy() to free the native curve.
+     */
     
     public class AbstractModulationData
     {
+        /** Curve types, for how values between keyframes are evaluated */
+        public static const LINE:int = 0;
+        public static const SPLINE:int = 1;
+        
         protected var _keyframes:Vector.<ModulationKeyframe>;
         protected var _rate:uint;
         protected var _sorted:Boolean;
         
+        /** The native curve, allocated on first use once there are keyframes */
+        private var _curve:uint = 0;
+        
         public function AbstractModulationData(rate:uint = 44100)
         {
             this._rate = rate;
@@ -24,6 +36,38 @@ package com.noteflight.standingwave3.modulation
         {
             return _rate;
         }
+        
+        /** The type of curve through the keyframes, LINE or SPLINE */
+        protected function get curveType():int
+        {
+            return LINE;
+        }
+        
+        /**
+         * The native curve holding these keyframes, or 0 while there are none, which the awave
+         * functions read as 0 everywhere. See Sample.allocateCurve().
+         */
+        public function get curve():uint
+        {
+            if (_curve == 0 && _keyframes.length > 0) {
+                _curve = Sample.allocateCurve(curveType);
+                for each (var kf:ModulationKeyframe in _keyframes) {
+                    Sample.addCurveKeyframe(_curve, kf.position, kf.value);
+                }
+            }
+            return _curve;
+        }
+        
+        /**
+         * Free the native curve. The data may still be used afterwards, and will allocate it again.
+         */
+        public function destroy():void
+        {
+            if (_curve) {
+                Sample.deallocateCurve(_curve);
+                _curve = 0;
+            }
+        }
     
         public function getKeyframes(fromOffset:Number=0, toOffset:Number=-1):Array
         {
@@ -109,9 +153,16 @@ package com.noteflight.standingwave3.modulation
          */ 
         protected function insert(kf:ModulationKeyframe):void 
         {
-            _keyframes.push(kf);
-            sort();
-            // _sorted = false;
+            // Keyframes usually arrive in order, so search for the insertion point from the end.
+            // Keyframes at the same position stay in the order they were added.
+            var i:int = _keyframes.length;
+            while (i > 0 && _keyframes[i-1].position > kf.position) {
+                i--;
+            }
+            _keyframes.splice(i, 0, kf);
+            if (_curve) {
+                Sample.addCurveKeyframe(_curve, kf.position, kf.value);
+            }
         }
         
         protected function sort():void 
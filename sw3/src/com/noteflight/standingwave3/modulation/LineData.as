@@ -1,6 +1,8 @@
 package com.noteflight.standingwave3.modulation
 {
     import __AS3__.vec.Vector;    
+    
+    import com.noteflight.standingwave3.elements.Sample;
 
     public class LineData extends AbstractModulationData implements IModulationData
     {
@@ -25,22 +27,7 @@ package com.noteflight.standingwave3.modulation
         /** Return the value of the modulation data at the specififed position */
         public function getValueAtPosition(position:Number):Number
         {
-            // See if there's a keyframe at this position
-            var kfAt:ModulationKeyframe = getKeyframeAt(position);
-            if (kfAt) {
-                return kfAt.value;
-            }
-            // Get the keyframes on either side of this position
-            var kfBefore:ModulationKeyframe = getKeyframeBefore(position);
-            var kfAfter:ModulationKeyframe = getKeyframeAfter(position);
-            // Else, are we after the last keyframe?
-            if (kfAfter == null) {
-                return kfBefore.value;
-            } 
-            // Else interpolate the value in between
-            var fractionalPosition:Number =  (position - kfBefore.position) / (kfAfter.position - kfBefore.position);
-            var value:Number = linearInterpolate( kfBefore.value, kfAfter.value, fractionalPosition);
-            return value;
+            return Sample.curveValue(curve, position);
         }
         
         // Return all of the segments for a range... ie from end to end including keyframes
@@ -0,0 +1,31 @@
+package com.noteflight.standingwave3.modulation
+{
+    /**
+     * A ModulationCursor is one voice's read position in some modulation data.
+     * It remembers the keyframe segment last read, so that reading the data forward
+     * block by block needs no search.
+     */
+    public class ModulationCursor
+    {
+        /** The modulation data being read */
+        public var data:AbstractModulationData;
+        
+        /** The frame position of the next value to read */
+        public var position:Number = 0;
+        
+        /** The index of the keyframe starting the segment last read, maintained by the native curve */
+        public var index:int = 0;
+        
+        public function ModulationCursor(data:AbstractModulationData)
+        {
+            this.data = data;
+        }
+        
+        /** Move the cursor back to the start of the data */
+        public function reset():void
+        {
+            position = 0;
+            index = 0;
+        }
+    }
+}
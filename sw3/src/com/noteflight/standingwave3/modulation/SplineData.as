@@ -1,6 +1,6 @@
 package com.noteflight.standingwave3.modulation
 {
-    /** Not implemented yet. Use LineData. */
+    /** SplineData is evaluated as a smooth cubic curve through its keyframes, rather than straight lines. */
     
     public class SplineData extends LineData
     {
@@ -8,6 +8,11 @@ package com.noteflight.standingwave3.modulation
         {
             super(rate);   
         }
+        
+        override protected function get curveType():int
+        {
+            return SPLINE;
+        }
 
     }
 }
\ No newline at end of file
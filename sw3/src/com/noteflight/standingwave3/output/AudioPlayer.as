@@ -220,5 +220,55 @@ package com.noteflight.standingwave3.output
         {
             return _sampleHandler.latency;
         }
+        
+        /**
+         * Whether the number of frames obtained on each SampleDataEvent adapts to the render time.
+         * See AudioSampleHandler.
+         */
+        public function get adaptive():Boolean
+        {
+            return _sampleHandler.adaptive;
+        }
+        
+        public function set adaptive(value:Boolean):void
+        {
+            _sampleHandler.adaptive = value;
+        }
+        
+        /**
+         * The number of frames currently obtained on each SampleDataEvent. 
+         */
+        [Bindable("positionChange")]
+        public function get framesPerCallback():Number
+        {
+            return _sampleHandler.framesPerCallback;
+        }
+        
+        /**
+         * The fraction of the last block's playing time left over after rendering it. 
+         */
+        [Bindable("positionChange")]
+        public function get headroom():Number
+        {
+            return _sampleHandler.headroom;
+        }
+        
+        /**
+         * The number of blocks that came close to missing their deadline. 
+         */
+        [Bindable("positionChange")]
+        public function get nearMisses():int
+        {
+            return _sampleHandler.nearMisses;
+        }
+        
+        /**
+         * The number of times the block size has been adapted. 
+         */
+        [Bindable("positionChange")]
+        public function get blockSizeChanges():int
+        {
+            return _sampleHandler.blockSizeChanges;
+        }
     }
 }
\ No newline at end of file
@@ -30,15 +30,49 @@ package com.noteflight.standingwave3.output
     /**
      * A delegate object that takes care of the work for audio playback by moving data
      * from an IAudioSource into a SampleDataEvent's ByteArray.
+     * 
+     * If adaptive is set, the handler measures how long each frame takes to render against the
+     * time that frame takes to play, and adjusts framesPerCallback to suit. Being per frame, the load
+     * doesn't change with the block size, so it falls back once rendering gets cheaper again. With plenty of headroom
+     * it halves the block size for lower latency. When render time nears the deadline it doubles
+     * the block size, so that Flash buffers more audio ahead of the playhead.
      */
     public class AudioSampleHandler extends EventDispatcher
     {
+        /** Flash requires between 2048 and 8192 frames for each SampleDataEvent */
+        public static const MIN_FRAMES_PER_CALLBACK:Number = 2048;
+        public static const MAX_FRAMES_PER_CALLBACK:Number = 8192;
+        
         /** Reports % of CPU used after each SampleDataEvent based on last event interval */
         public var cpuPercentage:Number = 0;
 
         /** frames supplied for each SampleDataEvent */
         public var framesPerCallback:Number;
         
+        /** Whether framesPerCallback adapts to the measured render time */
+        public var adaptive:Boolean = false;
+        
+        /** Fraction of the deadline under which rendering must stay for settleCallbacks blocks before the block size is lowered */
+        public var lowLoad:Number = 0.25;
+        
+        /** Fraction of the deadline over which a render counts as a near miss, and the block size is raised */
+        public var highLoad:Number = 0.7;
+        
+        /** Consecutive light blocks needed before the block size is lowered */
+        public var settleCallbacks:int = 8;
+        
+        /** The fraction of the last block's deadline left over after rendering it */
+        public var headroom:Number = 1;
+        
+        /** The number of blocks whose render time exceeded highLoad of their deadline */
+        public var nearMisses:int = 0;
+        
+        /** The number of times adaptation has changed framesPerCallback */
+        public var blockSizeChanges:int = 0;
+        
+        /** Consecutive blocks rendered under lowLoad */
+        private var _lightCallbacks:int = 0;
+        
         /** Overall gain factor for output. Deprecated. */
         public var gainFactor:Number = 1.0;
         
@@ -67,6 +101,9 @@ package com.noteflight.standingwave3.output
         // If non-null, the audio source being currently rendered        
         private var _source:IAudioSource;
         
+        // Silence pushed through while paused, kept from callback to callback
+        private var _silence:Sample;
+        
  
         public function AudioSampleHandler(framesPerCallback:Number = 4096)
         {
@@ -188,15 +225,18 @@ package com.noteflight.standingwave3.output
 				if (paused) 
 				{
 					// Push an empty sample through, if it is paused. This will accrue "dead frames"
-					sample = new Sample(_source.descriptor, length, true);
+					sample = silence(length);
 				} else {
 					// Get our output Sample.
 					sample = _source.getSample(length);  
 				}
 				
-				// Read the sample data to the ByteArray provided by the handler, and then clean up
+				// Read the sample data to the ByteArray provided by the handler, and then clean up,
+				// unless the sample is one that its source or this handler reuses
 				sample.writeBytes(e.data, 0, length);    
-				sample.destroy();
+				if (!sample.borrowed) {
+					sample.destroy();
+				}
    			} 
              
             if (length <= 0) 
@@ -217,10 +257,64 @@ package com.noteflight.standingwave3.output
                 dispatchEvent(new Event(Event.SOUND_COMPLETE)); // Event.SOUND_COMPLETE
             }
 
+            // Adapt the block size for the next callback
+            if (length > 0 && !paused) {
+                adaptBlockSize(getTimer() - now, length);
+            }
+            
             // Calculate CPU utilization
             calculateCpu(now);
             
         }
+        
+        /**
+         * A silent sample of the current source's format, reused while paused.
+         */
+        private function silence(length:Number):Sample
+        {
+            if (!_silence || _silence.capacity < length || !AudioDescriptor.compare(_silence.descriptor, _source.descriptor)) {
+                if (_silence) {
+                    _silence.borrowed = false;
+                    _silence.destroy();
+                }
+                _silence = new Sample(_source.descriptor, Math.max(length, MAX_FRAMES_PER_CALLBACK), true);
+                _silence.borrowed = true;
+            }
+            _silence.resize(length);
+            return _silence;
+        }
+        
+        /**
+         * Compare the time taken to render each frame of a block with the time it will take to play,
+         * and if adaptive, change the block size for the next callback. Called after every callback,
+         * and public so that a host or benchmark can drive the adaptation with its own timings.
+         * @param renderTime the time taken to render the block, in ms
+         * @param frames the number of frames rendered, which may be fewer than framesPerCallback
+         */
+        public function adaptBlockSize(renderTime:Number, frames:Number):void
+        {
+            var framePeriod:Number = 1000 / AudioDescriptor.RATE_44100;
+            var load:Number = (renderTime / frames) / framePeriod;
+            headroom = 1 - load;
+            
+            if (load >= highLoad) {
+                nearMisses++;
+                _lightCallbacks = 0;
+                if (adaptive && framesPerCallback < MAX_FRAMES_PER_CALLBACK) {
+                    framesPerCallback = Math.min(MAX_FRAMES_PER_CALLBACK, framesPerCallback * 2);
+                    blockSizeChanges++;
+                }
+            } else if (load < lowLoad) {
+                _lightCallbacks++;
+                if (adaptive && _lightCallbacks >= settleCallbacks && framesPerCallback > MIN_FRAMES_PER_CALLBACK) {
+                    framesPerCallback = Math.max(MIN_FRAMES_PER_CALLBACK, framesPerCallback / 2);
+                    blockSizeChanges++;
+                    _lightCallbacks = 0;
+                }
+            } else {
+                _lightCallbacks = 0;
+            }
+        }
 
         private function calculateCpu(now:Number):void
         {
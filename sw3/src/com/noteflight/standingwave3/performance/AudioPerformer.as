@@ -19,25 +19,108 @@ package com.noteflight.standingwave3.performance
     import __AS3__.vec.Vector;
     
     import com.noteflight.standingwave3.elements.*;
+    import com.noteflight.standingwave3.modulation.Mod;
     import com.noteflight.standingwave3.utils.AudioUtils;
     
+    import flash.utils.getTimer;
+    
     /**
      * An AudioPerformer takes a Performance containing a queryable collection of
      * PerformableAudioSources (i.e. timed playbacks of audio sources) and exposes
      * it as an IAudioSource that can realize time samples of the performance output.
      * The main job of the AudioPerformer is to mix together all the performance
      * elements, time-shifted appropriately.
+     * 
+     * For realtime playback, the number of voices mixed at once may be limited by maxVoices
+     * and by cpuBudget. When there are too many, the voices with the lowest estimated level are
+     * stolen: each is faded out over stealFrames and then dropped. Older voices are assumed to have
+     * decayed, so they rank lower. The limits apply to getSample() only, never to bounce().
+     * 
+     * Elements may be routed to named submix buses, created with createBus(), whose effects
+     * run once per block over everything mixed into them. See MixBus.
+     * 
+     * With reuseBuffers set, the output block, the bus blocks and the scratch blocks that voices
+     * render into are kept from one block to the next, so that once the performer has warmed up,
+     * rendering a block of voices that are IBufferedSources allocates nothing. blockAllocations
+     * counts what the last block did allocate.
+     * 
+     * While RenderTrace is recording, each block, voice and bus is traced as a span.
+     * 
+     * Voices that are IReleasableSources are released as soon as they stop sounding, freeing their native state.
      */
     public class AudioPerformer implements IAudioSource
     {
     	/** Fixed gain factor to apply to all sources while mixing into the output buss */
     	public var mixGain:Number = 0.0;
     	
+    	/** The number of frames rendered at a time while bouncing */
+    	public static const BOUNCE_FRAMES:Number = 4096;
+    	
+    	/** The most voices to mix at once, or 0 for no limit */
+    	public var maxVoices:int = 0;
+    	
+    	/** 
+    	 * The largest fraction of real time to spend mixing voices, or 0 for no limit.
+    	 * For example, 0.5 limits the voices to as many as can be mixed in half the duration of each block. 
+    	 */
+    	public var cpuBudget:Number = 0;
+    	
+    	/** The number of frames over which a stolen voice is faded out */
+    	public var stealFrames:int = 256;
+    	
+    	/** Decibels per second by which a voice's estimated level falls as it sounds, so older voices are stolen first */
+    	public var voiceAging:Number = 6;
+    	
+    	/** 
+    	 * Whether getSample() reuses its blocks rather than allocating new ones. The Sample it returns then
+    	 * belongs to the performer and is overwritten by the next call. It is marked borrowed, so destroying it,
+    	 * as AudioSampleHandler and filters downstream do, leaves it alone.
+    	 */
+    	public var reuseBuffers:Boolean = false;
+    	
         private var _performance:IPerformance;
         private var _position:Number = 0;
         private var _frameCount:Number = 0;
         private var _activeElements:Vector.<PerformableAudioSource>;
 		private var _descriptor:AudioDescriptor;
+		
+		/** The retained result of the last bounce, patched up by bounceIncremental() */
+		private var _mixdown:Sample;
+		
+		/** Stolen voices that are still fading out */
+		private var _releasing:Vector.<VoiceRelease> = new Vector.<VoiceRelease>();
+		
+		/** Finished VoiceReleases, kept to be reused for the next stolen voices */
+		private var _spareReleases:Vector.<VoiceRelease> = new Vector.<VoiceRelease>();
+		
+		/** Estimated milliseconds to mix one frame of one voice, averaged over recent blocks */
+		private var _voiceCost:Number = 0;
+		
+		private var _culledVoices:int = 0;
+		private var _totalCulledVoices:Number = 0;
+		private var _bouncing:Boolean = false;
+		
+		/** Submix buses, in the order they were created */
+		private var _buses:Vector.<MixBus> = new Vector.<MixBus>();
+		
+		/** The buses in mixing order, rebuilt each block */
+		private var _busOrder:Vector.<MixBus> = new Vector.<MixBus>();
+		
+		/** The list that becomes the active list at the end of each block, swapped with it to be reused */
+		private var _stillActive:Vector.<PerformableAudioSource> = new Vector.<PerformableAudioSource>();
+		
+		/** The elements starting in each block */
+		private var _startingElements:Vector.<PerformableAudioSource> = new Vector.<PerformableAudioSource>();
+		
+		/** With reuseBuffers, the output block, and scratch blocks for voices indexed by their channel count */
+		private var _block:Sample;
+		private var _voiceBlocks:Vector.<Sample> = new Vector.<Sample>(3, true);
+		
+		/** Pan factors and fade envelope, reused for every voice */
+		private var _gains:Object = {};
+		private var _releaseMod:Mod = new Mod();
+		
+		private var _blockAllocations:Number = 0;
                 
         /**
          * Construct a new AudioPerformer for a performance.
@@ -104,8 +187,135 @@ package com.noteflight.standingwave3.performance
          */
         public function resetPosition():void
         {
+            var element:PerformableAudioSource;
+            for each (element in _activeElements) {
+                releaseElement(element);
+            }
+            for each (var release:VoiceRelease in _releasing) {
+                releaseElement(release.element);
+                _spareReleases.push(release);
+            }
             _position = 0;
             _activeElements = new Vector.<PerformableAudioSource>();
+            _releasing.length = 0;
+            for each (var bus:MixBus in _buses) {
+                bus.resetPosition();
+            }
+        }
+        
+        /**
+         * Create a named submix bus. Route elements to it by setting their bus to its name.
+         * @param name the bus name, which must be unique within this performer
+         * @param output the bus to mix into, or null for this performer's output
+         * @param gain the gain in decibels at which the bus is mixed into its output
+         */
+        public function createBus(name:String, output:String = null, gain:Number = 0):MixBus
+        {
+            if (getBus(name)) {
+                throw new Error("There is already a mix bus named " + name);
+            }
+            var bus:MixBus = new MixBus(name, _descriptor, output, gain);
+            _buses.push(bus);
+            return bus;
+        }
+        
+        /**
+         * The bus with a given name, or null if there is none.
+         */
+        public function getBus(name:String):MixBus
+        {
+            for each (var bus:MixBus in _buses) {
+                if (bus.name == name) {
+                    return bus;
+                }
+            }
+            return null;
+        }
+        
+        /**
+         * Remove a bus. Elements and buses still routed to it will cause an error when mixed.
+         * @return true if the bus was found and removed
+         */
+        public function removeBus(name:String):Boolean
+        {
+            var bus:MixBus = getBus(name);
+            if (!bus) {
+                return false;
+            }
+            bus.resetPosition();
+            _buses.splice(_buses.indexOf(bus), 1);
+            return true;
+        }
+        
+        /**
+         * The number of voices culled by the voice limits while rendering the last block.
+         */
+        public function get culledVoices():int
+        {
+            return _culledVoices;
+        }
+        
+        /**
+         * The number of voices culled by the voice limits since this AudioPerformer was created.
+         */
+        public function get totalCulledVoices():Number
+        {
+            return _totalCulledVoices;
+        }
+        
+        /**
+         * The estimated cost of mixing one voice, in milliseconds per second of audio.
+         * This is 0 until a block has been rendered.
+         */
+        public function get voiceCost():Number
+        {
+            return _voiceCost * _descriptor.rate;
+        }
+        
+        /**
+         * The number of Samples and blocks of sample memory allocated while rendering the last block,
+         * as counted by Sample.allocations. With reuseBuffers, this should fall to 0 after warm-up.
+         * 
+         * Other allocations are not counted. The built-in render path reuses its own small objects,
+         * such as awave settings, envelope Mods, pan factors and VoiceReleases. Still uncounted are
+         * objects made by other sources and filters, Numbers that the player boxes, and native memory
+         * outside the sample memory, such as modulation curves and filter state.
+         */
+        public function get blockAllocations():Number
+        {
+            return _blockAllocations;
+        }
+        
+        /**
+         * Free the blocks kept by reuseBuffers. They are allocated again if needed.
+         */
+        public function releaseBuffers():void
+        {
+            if (_block) {
+                discardBlock(_block);
+                _block = null;
+            }
+            for (var c:int = 0; c < _voiceBlocks.length; c++) {
+                if (_voiceBlocks[c]) {
+                    discardBlock(_voiceBlocks[c]);
+                    _voiceBlocks[c] = null;
+                }
+            }
+            for each (var bus:MixBus in _buses) {
+                bus.releaseBlock();
+            }
+        }
+        
+        /**
+         * The number of voices currently allowed by maxVoices and cpuBudget, or int.MAX_VALUE for no limit.
+         */
+        public function get voiceLimit():int
+        {
+            var limit:int = (maxVoices > 0) ? maxVoices : int.MAX_VALUE;
+            if (cpuBudget > 0 && _voiceCost > 0) {
+                limit = Math.min(limit, Math.max(1, Math.floor(cpuBudget * 1000 / (_voiceCost * _descriptor.rate))));
+            }
+            return limit;
         }
         
         
@@ -115,14 +325,30 @@ package com.noteflight.standingwave3.performance
         */
         public function getSample(numFrames:Number):Sample
         {
+        	var allocations:Number = Sample.allocations;
+        	var traced:Boolean = RenderTrace.enabled;
+        	if (traced) {
+        		RenderTrace.begin("block", RenderTrace.BLOCK, numFrames, _position);
+        	}
         	
             // create our result sample and zero its samples out so we can add in the
             // audio from performance events that intersect our time interval.
-            var sample:Sample = new Sample(_descriptor, numFrames);
+            var sample:Sample;
+            if (reuseBuffers) {
+                sample = _block = scratchBlock(_block, _descriptor, numFrames);
+                sample.setSamples(0, 0, numFrames);
+            } else {
+                sample = new Sample(_descriptor, numFrames);
+            }
+            var bus:MixBus;
+            for each (bus in _buses) {
+                bus.begin(numFrames, reuseBuffers);
+            }
                         
             // Maintain a list of all PerformableAudioSources known to be active at the current
             // audio cursor position.
-            var _stillActive:Vector.<PerformableAudioSource> = new Vector.<PerformableAudioSource>();
+            var stillActive:Vector.<PerformableAudioSource> = _stillActive;
+            stillActive.length = 0;
             
             var element:PerformableAudioSource;
             var i:Number;
@@ -132,12 +358,18 @@ package com.noteflight.standingwave3.performance
             // Prior to generating any audio date, update the active element list with 
             // any PerformableAudioSources that intersect the time interval of interest.
             //
-            var elements:Vector.<PerformableAudioSource> = _performance.getElementsInRange(_position, _position + numFrames);
+            var elements:Vector.<PerformableAudioSource> = _performance.getElementsInRange(_position, _position + numFrames, _startingElements);
             for (i = 0; i < elements.length; i++)
             {
                 elements[i].source.resetPosition();
                 _activeElements.push(elements[i]);
             }
+            
+            if (!_bouncing) {
+                cullVoices();
+            }
+            var startTime:int = getTimer();
+            var voiceFrames:Number = 0;
 
             // Process all active elements by adding the active section of their signal
             // into our result sample, and retaining them in the next copy of the active list
@@ -156,23 +388,450 @@ package com.noteflight.standingwave3.performance
                 // If anything to do, then add the element's signal into our result.
                 if (activeLength > 0)
                 {
-      				// Mix the element into the output mix bus
-                	mix(sample, element, activeOffset, activeLength);	
+      				// Mix the element into the output mix bus, or its submix
+                	if (traced) {
+                		RenderTrace.begin(RenderTrace.nameOf(element.source), RenderTrace.VOICE, activeLength, element.start);
+                	}
+                	mix(targetOf(element, sample), element, activeOffset, activeLength);	
+                	if (traced) {
+                		RenderTrace.end();
+                	}
+                	voiceFrames += activeLength;
                 }
                 
                 // If this element is still going to be active in the next batch of frames, take note of that.
                 if (element.end > _position + numFrames)
                 {
-                    _stillActive.push(element);
+                    stillActive.push(element);
+                }
+                else
+                {
+                    releaseElement(element);
                 }
             }
             
-            _activeElements = _stillActive;
+            _stillActive = _activeElements;
+            _activeElements = stillActive;
+            voiceFrames += mixReleases(sample, numFrames);
+            
+            // Fold this block's timing into the running estimate of the cost per voice
+            if (!_bouncing && voiceFrames > 0) {
+                var cost:Number = (getTimer() - startTime) / voiceFrames;
+                _voiceCost = (_voiceCost > 0) ? (0.9 * _voiceCost + 0.1 * cost) : cost;
+            }
+            
+            // Run each submix through its effects and into its output, deepest buses first
+            for each (bus in busOrder()) {
+                if (traced) {
+                    RenderTrace.begin(bus.name, RenderTrace.BUS, numFrames);
+                }
+                var busSample:Sample = bus.render(numFrames, reuseBuffers);
+                var output:Sample = bus.output ? requireBus(bus.output).block : sample;
+                output.mixIn(busSample, AudioUtils.decibelsToFactor(bus.gain), 0);
+                if (busSample != bus.block) {
+                    busSample.destroy();
+                }
+                if (traced) {
+                    RenderTrace.end();
+                }
+            }
             _position += numFrames;
+            _blockAllocations = Sample.allocations - allocations;
+            if (traced) {
+                RenderTrace.end();
+            }
 
             return sample;
         }
         
+        /**
+         * A borrowed block of numFrames, reusing an old block if it is intact, of this format and has
+         * the capacity, or else discarding it and allocating a new one. The contents are left as they were.
+         */
+        internal static function scratchBlock(block:Sample, descriptor:AudioDescriptor, numFrames:Number):Sample
+        {
+            if (block && !block.evicted && block.capacity >= numFrames && AudioDescriptor.compare(block.descriptor, descriptor)) {
+                block.resize(numFrames);
+                return block;
+            }
+            if (block) {
+                discardBlock(block);
+            }
+            block = new Sample(descriptor, numFrames, false);
+            block.borrowed = true;
+            return block;
+        }
+        
+        /**
+         * Destroy a block made by scratchBlock().
+         */
+        internal static function discardBlock(block:Sample):void
+        {
+            block.borrowed = false;
+            block.destroy();
+        }
+        
+        /**
+         * Render the next frames of an element that is not mixed directly from its sample memory.
+         * With reuseBuffers, a buffered source renders into a scratch voice block, which is kept.
+         * Pass the result to releaseElementSample() when done with it.
+         */
+        private function renderElement(element:PerformableAudioSource, numFrames:Number):Sample
+        {
+            var source:IBufferedSource = element.source as IBufferedSource;
+            if (!reuseBuffers || !source) {
+                return element.source.getSample(numFrames);
+            }
+            var channels:int = source.descriptor.channels;
+            var block:Sample = _voiceBlocks[channels] = scratchBlock(_voiceBlocks[channels], source.descriptor, numFrames);
+            source.renderInto(block, numFrames);
+            return block;
+        }
+        
+        /**
+         * Free any native state held by an element that has stopped sounding.
+         */
+        private function releaseElement(element:PerformableAudioSource):void
+        {
+            var source:IReleasableSource = element.source as IReleasableSource;
+            if (source) {
+                source.releaseState();
+            }
+        }
+        
+        private function releaseElementSample(elementSample:Sample):void
+        {
+            if (elementSample != _voiceBlocks[elementSample.channels]) {
+                elementSample.destroy();
+            }
+        }
+        
+        /**
+         * The sample that an element mixes into: its bus's submix, or the output block.
+         */
+        private function targetOf(element:PerformableAudioSource, sample:Sample):Sample
+        {
+            return element.bus ? requireBus(element.bus).block : sample;
+        }
+        
+        private function requireBus(name:String):MixBus
+        {
+            var bus:MixBus = getBus(name);
+            if (!bus) {
+                throw new Error("There is no mix bus named " + name);
+            }
+            return bus;
+        }
+        
+        /**
+         * The buses ordered so that each comes before the bus it mixes into.
+         */
+        private function busOrder():Vector.<MixBus>
+        {
+            // Insert each bus after those at least as deep, in the reused order vector
+            _busOrder.length = 0;
+            for each (var bus:MixBus in _buses) {
+                var depth:int = busDepth(bus);
+                var i:int = _busOrder.length;
+                _busOrder.push(bus);
+                while (i > 0 && busDepth(_busOrder[i - 1]) < depth) {
+                    _busOrder[i] = _busOrder[i - 1];
+                    i--;
+                }
+                _busOrder[i] = bus;
+            }
+            return _busOrder;
+        }
+        
+        /**
+         * Count the hops from a bus to the output. More hops than buses means the routing loops.
+         */
+        private function busDepth(bus:MixBus):int
+        {
+            var depth:int = 0;
+            for (var b:MixBus = bus; b.output; b = requireBus(b.output)) {
+                if (++depth > _buses.length) {
+                    throw new Error("Mix bus " + bus.name + " is routed in a loop.");
+                }
+            }
+            return depth;
+        }
+        
+        /**
+         * If more voices are active than the voice limit allows, steal those with the lowest
+         * estimated level. Voices that have not yet sounded are dropped outright, and the rest fade out.
+         */
+        private function cullVoices():void
+        {
+            _culledVoices = 0;
+            var excess:int = _activeElements.length - voiceLimit;
+            if (excess <= 0) {
+                return;
+            }
+            
+            _activeElements.sort(compareLevels);
+            for (var i:int = 0; i < excess; i++) {
+                var element:PerformableAudioSource = _activeElements[i];
+                if (element.start < _position && stealFrames > 0) {
+                    var release:VoiceRelease = _spareReleases.length ? _spareReleases.pop() : new VoiceRelease();
+                    release.element = element;
+                    release.totalFrames = stealFrames;
+                    release.doneFrames = 0;
+                    _releasing.push(release);
+                } else {
+                    releaseElement(element);
+                }
+            }
+            for (i = excess; i < _activeElements.length; i++) {
+                _activeElements[i - excess] = _activeElements[i];
+            }
+            _activeElements.length -= excess;
+            _culledVoices = excess;
+            _totalCulledVoices += excess;
+        }
+        
+        /**
+         * The estimated level of a voice in decibels: its gain, less voiceAging for each second it has sounded. 
+         */
+        private function estimateLevel(element:PerformableAudioSource):Number
+        {
+            return element.gain - voiceAging * Math.max(0, _position - element.start) / _descriptor.rate;
+        }
+        
+        private function compareLevels(a:PerformableAudioSource, b:PerformableAudioSource):Number
+        {
+            return estimateLevel(a) - estimateLevel(b);
+        }
+        
+        /**
+         * Mix the next stretch of each stolen voice's fade out into a block, dropping those that have finished.
+         * @return the number of voice frames mixed
+         */
+        private function mixReleases(sample:Sample, numFrames:Number):Number
+        {
+            var voiceFrames:Number = 0;
+            var kept:int = 0;
+            var traced:Boolean = RenderTrace.enabled;
+            for each (var release:VoiceRelease in _releasing)
+            {
+                var element:PerformableAudioSource = release.element;
+                var length:Number = Math.min(numFrames, release.totalFrames - release.doneFrames, element.end - _position);
+                if (length <= 0) {
+                    releaseElement(element);
+                    _spareReleases.push(release);
+                    continue;
+                }
+                var startGain:Number = 1 - release.doneFrames / release.totalFrames;
+                var endGain:Number = 1 - (release.doneFrames + length) / release.totalFrames;
+                if (traced) {
+                    RenderTrace.begin(RenderTrace.nameOf(element.source), RenderTrace.VOICE, length, element.start);
+                }
+                var elementSample:Sample = renderElement(element, length);
+                _releaseMod.y0 = _releaseMod.y1 = startGain;
+                _releaseMod.y2 = _releaseMod.y3 = endGain;
+                elementSample.envelope(_releaseMod);
+                mixElementSample(targetOf(element, sample), element, elementSample, 0);
+                releaseElementSample(elementSample);
+                if (traced) {
+                    RenderTrace.end();
+                }
+                
+                voiceFrames += length;
+                release.doneFrames += length;
+                if (release.doneFrames < release.totalFrames && element.end > _position + numFrames) {
+                    // Keep it, compacting the list in place
+                    _releasing[kept++] = release;
+                } else {
+                    releaseElement(element);
+                    _spareReleases.push(release);
+                }
+            }
+            _releasing.length = kept;
+            return voiceFrames;
+        }
+        
+        /**
+         * The mixdown retained from the last call to bounce() or bounceIncremental(), if any.
+         */
+        public function get mixdown():Sample
+        {
+            return _mixdown;
+        }
+        
+        /**
+         * Render the entire performance into a single Sample. The result is retained
+         * as the mixdown, so that later edits can be patched in with bounceIncremental().
+         * The mixdown belongs to this AudioPerformer, so don't destroy it yourself.
+         */
+        public function bounce():Sample
+        {
+        	if (_mixdown) {
+        		_mixdown.destroy();
+        	}
+        	_mixdown = new Sample(_descriptor, _frameCount);
+        	startBounce();
+        	continueBounce(_mixdown, _frameCount);
+        	finishBounce();
+        	
+        	if (_performance is ListPerformance) {
+        		ListPerformance(_performance).clearDirtyRanges();
+        	}
+        	return _mixdown;
+        }
+        
+        /**
+         * Start a bounce from the beginning of the performance, to be rendered by continueBounce().
+         * Bounces are not realtime, so every voice is rendered.
+         */
+        internal function startBounce():void
+        {
+        	_bouncing = true;
+        	resetPosition();
+        }
+        
+        /**
+         * Carry on a bounce up to a frame, in the same blocks of BOUNCE_FRAMES that bounce() renders,
+         * mixing them into a target sample holding the whole performance.
+         */
+        internal function continueBounce(target:Sample, toFrame:Number):void
+        {
+        	toFrame = Math.min(toFrame, _frameCount);
+        	while (_position < toFrame) {
+        		var offset:Number = _position;
+        		var block:Sample = getSample(Math.min(BOUNCE_FRAMES, toFrame - _position));
+        		target.mixIn(block, 1.0, offset);
+        		if (!reuseBuffers) {
+        			block.destroy();
+        		}
+        	}
+        }
+        
+        /**
+         * End a bounce, returning the performer to the start for playback.
+         */
+        internal function finishBounce():void
+        {
+        	resetPosition();
+        	_bouncing = false;
+        }
+        
+        /**
+         * Bring the retained mixdown up to date by re-rendering only the ranges of a 
+         * ListPerformance that have been edited since the last bounce.
+         * Each dirty window is widened to whole blocks of BOUNCE_FRAMES, then cleared and remixed
+         * from every element sounding in it. Elements that began earlier are re-rolled up to the window
+         * start in the same blocks that bounce() pulls, so stateful filters arrive in the same state
+         * and the window matches a full bounce().
+         * Falls back to a full bounce() if there is no mixdown yet, if the
+         * performance cannot report its dirty ranges, or if there are mix buses,
+         * whose effects carry state from one window into the next.
+         * The performer is extended if the performance has grown past its end.
+         */
+        public function bounceIncremental():Sample
+        {
+        	var list:ListPerformance = _performance as ListPerformance;
+        	if (!_mixdown || !list || _buses.length > 0) {
+        		return bounce();
+        	}
+        	
+        	// Grow the mixdown if the edits made the performance longer
+        	if (list.frameCount > _frameCount) {
+        		_frameCount = list.frameCount;
+        	}
+        	if (_mixdown.frameCount != _frameCount) {
+        		var resized:Sample = new Sample(_descriptor, _frameCount);
+        		resized.mixIn(_mixdown, 1.0, 0);
+        		_mixdown.destroy();
+        		_mixdown = resized;
+        	}
+        	
+        	var ranges:Array = list.dirtyRanges;
+        	for (var r:int = 0; r < ranges.length; r += 2) {
+        		var windowStart:Number = Math.max(0, Math.floor(ranges[r] / BOUNCE_FRAMES) * BOUNCE_FRAMES);
+        		var windowEnd:Number = Math.min(_frameCount, Math.ceil(ranges[r+1] / BOUNCE_FRAMES) * BOUNCE_FRAMES);
+        		if (windowEnd > windowStart) {
+        			_mixdown.setSamples(0.0, windowStart, windowEnd - windowStart);
+        			renderWindow(list, _mixdown, windowStart, windowEnd);
+        		}
+        	}
+        	list.clearDirtyRanges();
+        	resetPosition();
+        	return _mixdown;
+        }
+        
+        /**
+         * Mix every element sounding within a window of a ListPerformance into a target sample
+         * holding the whole performance. The window must start on a multiple of BOUNCE_FRAMES.
+         */
+        private function renderWindow(list:ListPerformance, target:Sample, windowStart:Number, windowEnd:Number):void
+        {
+        	var elements:Vector.<PerformableAudioSource> = list.getElementsOverlappingRange(windowStart, windowEnd);
+        	var element:PerformableAudioSource;
+        	
+        	// Roll any element that started before the window forward to the window start
+        	for each (element in elements)
+        	{
+        		element.source.resetPosition();
+        		if (element.start < windowStart) {
+        			prerollElement(element, windowStart);
+        		}
+        	}
+        	
+        	// Then mix in block by block, just as getSample() would
+        	for (var blockStart:Number = windowStart; blockStart < windowEnd; blockStart += BOUNCE_FRAMES)
+        	{
+        		var blockLength:Number = Math.min(BOUNCE_FRAMES, windowEnd - blockStart);
+        		for each (element in elements)
+        		{
+        			var activeOffset:Number = Math.max(0, element.start - blockStart);
+        			var activeLength:Number = Math.round( Math.min(blockLength - activeOffset, element.end - (blockStart + activeOffset)) );
+        			if (activeLength > 0)
+        			{
+        				mix(target, element, blockStart + activeOffset, activeLength);
+        			}
+        		}
+        	}
+        	
+        	// Each window re-rolls its elements from the start, so none need their state kept
+        	for each (element in elements)
+        	{
+        		releaseElement(element);
+        	}
+        }
+        
+        /**
+         * Roll an element that began before a frame forward to it, pulling its source in the same
+         * lengths that bounce() would, block by block, so that a stateful source ends up in the same state.
+         */
+        private function prerollElement(element:PerformableAudioSource, toFrame:Number):void
+        {
+        	for (var blockStart:Number = Math.floor(element.start / BOUNCE_FRAMES) * BOUNCE_FRAMES; blockStart < toFrame; blockStart += BOUNCE_FRAMES)
+        	{
+        		var blockLength:Number = Math.min(BOUNCE_FRAMES, toFrame - blockStart);
+        		var activeOffset:Number = Math.max(0, element.start - blockStart);
+        		var activeLength:Number = Math.round( Math.min(blockLength - activeOffset, element.end - (blockStart + activeOffset)) );
+        		if (activeLength > 0) {
+        			skipElement(element, activeLength);
+        		}
+        	}
+        }
+        
+        /**
+         * Advance an element's source by some number of frames without mixing it.
+         */
+        private function skipElement(element:PerformableAudioSource, numFrames:Number):void
+        {
+        	if (testIDirect(element, numFrames)) {
+        		IDirectAccessSource(element.source).useSample(numFrames);
+        		return;
+        	}
+        	while (numFrames > 0) {
+        		var n:Number = Math.min(numFrames, BOUNCE_FRAMES);
+        		element.source.getSample(n).destroy();
+        		numFrames -= n;
+        	}
+        }
+        
         /** Mix buss. Can mix stereo samples, mono samples, or pan out mono sources to a stereo buss.
         */
         private function mix(sample:Sample, element:PerformableAudioSource, activeOffset:Number, activeLength:Number, stereoize:Boolean=false):void
@@ -186,17 +845,17 @@ package com.noteflight.standingwave3.performance
          		// Do a stereo panning mix of mono elements. 
          		// Look at the pan position of each element and call mixInPan instead
          		if (descriptor.rate == element.source.descriptor.rate) {
-	         		var gains:Object = AudioUtils.panToFactors(element.pan);
+	         		var gains:Object = AudioUtils.panToFactors(element.pan, -3, _gains);
 	         		gains.right *= fgain;
 	         		gains.left *= fgain;
 	            	if (testIDirect(element, activeLength)) {
 	            		p = element.source.position;
 	            		IDirectAccessSource(element.source).useSample(activeLength);
 	            		sample.mixInPanDirectAccessSource(IDirectAccessSource(element.source), p, gains.left, gains.right, activeOffset, activeLength);
-	            	} else {
-	                	elementSample = element.source.getSample(activeLength);
-	                	sample.mixInPan(elementSample, gains.left, gains.right, activeOffset);
-	                	elementSample.destroy();
+	            	} else if (!mixGainRamp(sample, element, activeOffset, activeLength, gains.left, gains.right, true)) {
+	                	elementSample = renderElement(element, activeLength);
+	                	mixElementSample(sample, element, elementSample, activeOffset);
+	                	releaseElementSample(elementSample);
 	                }	
 	          	} else {
 	          		throw new Error("Cannot mix sources with incompatible AudioDescriptors.");
@@ -210,11 +869,11 @@ package com.noteflight.standingwave3.performance
 	            		IDirectAccessSource(element.source).useSample(activeLength);
 	            		// Mix it in, without using an intermediate sample
 	            		sample.mixInDirectAccessSource(IDirectAccessSource(element.source), p, fgain, activeOffset, activeLength);
-	            	} else {
+	            	} else if (!mixGainRamp(sample, element, activeOffset, activeLength, fgain, fgain, false)) {
 	            		// Do a regular getSample, mix, and destroy
-	                	elementSample = element.source.getSample(activeLength);
-	                	sample.mixIn(elementSample, fgain, activeOffset);
-	                	elementSample.destroy();
+	                	elementSample = renderElement(element, activeLength);
+	                	mixElementSample(sample, element, elementSample, activeOffset);
+	                	releaseElementSample(elementSample);
 	                }	
 	      		} else {
 	      			throw new Error("Cannot mix sources with incompatible AudioDescriptors.");
@@ -222,6 +881,49 @@ package com.noteflight.standingwave3.performance
          	}
         }
         
+        /**
+         * Mix an IGainRampSource element from its unscaled source, folding its fade into the mix pass.
+         * Returns false, having mixed nothing, if the element's gain over this range is not a single ramp
+         * or its unscaled source is not directly accessible.
+         */
+        private function mixGainRamp(sample:Sample, element:PerformableAudioSource, activeOffset:Number, activeLength:Number,
+        	leftGain:Number, rightGain:Number, pan:Boolean):Boolean
+        {
+        	var source:IGainRampSource = element.source as IGainRampSource;
+        	if (!source) {
+        		return false;
+        	}
+        	var p:Number = element.source.position;
+        	var unscaled:IDirectAccessSource = source.unscaledSource;
+        	var ramp:Object = source.getGainRamp(p, activeLength);
+        	if (!unscaled || !ramp || !unscaled.getSamplePointer(p + activeLength - 1)) {
+        		return false;
+        	}
+        	source.useSample(activeLength);
+        	if (pan) {
+        		sample.mixInPanRampDirectAccessSource(unscaled, p, leftGain * ramp.start, leftGain * ramp.end, 
+        			rightGain * ramp.start, rightGain * ramp.end, ramp.curve, activeOffset, activeLength);
+        	} else {
+        		sample.mixInRampDirectAccessSource(unscaled, p, leftGain * ramp.start, leftGain * ramp.end, ramp.curve, activeOffset, activeLength);
+        	}
+        	return true;
+        }
+        
+        /**
+         * Mix a sample already rendered from an element into the mix buss, at the element's gain and pan.
+         * The descriptors must already have been checked by mix().
+         */
+        private function mixElementSample(sample:Sample, element:PerformableAudioSource, elementSample:Sample, activeOffset:Number):void
+        {
+        	var fgain:Number = AudioUtils.decibelsToFactor( mixGain + element.gain );
+        	if (_descriptor.channels == 2 && elementSample.channels == 1) {
+        		var gains:Object = AudioUtils.panToFactors(element.pan, -3, _gains);
+        		sample.mixInPan(elementSample, gains.left * fgain, gains.right * fgain, activeOffset);
+        	} else {
+        		sample.mixIn(elementSample, fgain, activeOffset);
+        	}
+        }
+        
         /** 
          * Determine whether an element's source is usable as an IDirectSource for this range 
          */
@@ -254,7 +956,28 @@ package com.noteflight.standingwave3.performance
         {
             var p:AudioPerformer = new AudioPerformer(_performance.clone(), _descriptor);
             p._frameCount = _frameCount; 
+            for each (var bus:MixBus in _buses) {
+                p._buses.push(bus.clone());
+            }
             return p;
         }
     }
-}
\ No newline at end of file
+}
+
+import com.noteflight.standingwave3.performance.PerformableAudioSource;
+
+/**
+ * A voice stolen by the AudioPerformer, and how far through its fade out it has got.
+ */
+internal class VoiceRelease
+{
+	public var element:PerformableAudioSource;
+	public var totalFrames:Number;
+	public var doneFrames:Number = 0;
+	
+	public function VoiceRelease(element:PerformableAudioSource = null, totalFrames:Number = 0)
+	{
+		this.element = element;
+		this.totalFrames = totalFrames;
+	}
+}
@@ -30,8 +30,9 @@ package com.noteflight.standingwave3.performance
          * 
          * @param start frame count of range start (inclusive)
          * @param end frame count of the range end (exclusive)
+         * @param result a vector to empty and fill with the elements, instead of a new one
          */
-        function getElementsInRange(start:Number, end:Number):Vector.<PerformableAudioSource>;
+        function getElementsInRange(start:Number, end:Number, result:Vector.<PerformableAudioSource> = null):Vector.<PerformableAudioSource>;
 
         /**
          * The number of sample frames in this performance. 
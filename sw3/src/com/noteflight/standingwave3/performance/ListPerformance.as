@@ -35,6 +35,9 @@ package com.noteflight.standingwave3.performance
         
         private var _lastIndex:Number = 0;
         
+        /** Flat array of [start, end) frame pairs that have been edited since the last clearDirtyRanges() */
+        private var _dirtyRanges:Array = [];
+        
         public function ListPerformance() {
         	//
         }
@@ -60,6 +63,110 @@ package com.noteflight.standingwave3.performance
             // not be the last element.
             //
             _frameCount = Math.max(_frameCount, element.end);
+            
+            // The new element's whole extent needs to be rendered
+            invalidateElement(element);
+        }
+        
+        /**
+         * Remove a Performance Element from this Performance.
+         * The range it used to occupy is marked dirty.
+         * @return true if the element was found and removed
+         */
+        public function removeElement(element:PerformableAudioSource):Boolean
+        {
+            var i:int = _elements.indexOf(element);
+            if (i < 0) {
+                return false;
+            }
+            invalidateElement(element);
+            _elements.splice(i, 1);
+            
+            // Recompute the cached duration, since we may have removed the long straw
+            _frameCount = 0;
+            for each (var el:PerformableAudioSource in _elements) {
+                _frameCount = Math.max(_frameCount, el.end);
+            }
+            return true;
+        }
+        
+        /**
+         * Move an element to a new onset, marking both its old and new extents dirty.
+         */
+        public function moveElement(element:PerformableAudioSource, startTime:Number):void
+        {
+            invalidateElement(element);
+            element.onset = startTime;
+            invalidateElement(element);
+            _dirty = true;
+            _frameCount = Math.max(_frameCount, element.end);
+        }
+        
+        /**
+         * Mark the extent of an element as needing to be re-rendered.
+         * If an element is changed in place (gain, pan, or its source's parameters), 
+         * call this before the change and again after it, so that both the old
+         * and new extents are covered. The extent runs through the end of the element's
+         * source, so any tail that the source renders is included.
+         */
+        public function invalidateElement(element:PerformableAudioSource):void
+        {
+            invalidateRange(element.start, element.end);
+        }
+        
+        /**
+         * Mark an arbitrary range of frames as needing to be re-rendered.
+         * Overlapping and adjacent ranges are merged.
+         * @param start the first dirty frame (inclusive)
+         * @param end the last dirty frame (exclusive)
+         */
+        public function invalidateRange(start:Number, end:Number):void
+        {
+            if (end <= start) {
+                return;
+            }
+            var merged:Array = [];
+            var inserted:Boolean = false;
+            for (var r:int = 0; r < _dirtyRanges.length; r += 2) {
+                var rStart:Number = _dirtyRanges[r];
+                var rEnd:Number = _dirtyRanges[r+1];
+                if (rEnd < start) {
+                    // Entirely before the new range
+                    merged.push(rStart, rEnd);
+                } else if (rStart > end) {
+                    // Entirely after the new range
+                    if (!inserted) {
+                        merged.push(start, end);
+                        inserted = true;
+                    }
+                    merged.push(rStart, rEnd);
+                } else {
+                    // Overlapping, so grow the new range to cover it
+                    start = Math.min(start, rStart);
+                    end = Math.max(end, rEnd);
+                }
+            }
+            if (!inserted) {
+                merged.push(start, end);
+            }
+            _dirtyRanges = merged;
+        }
+        
+        /**
+         * The ranges that have been edited since the last call to clearDirtyRanges(),
+         * as a flat, sorted array of [start, end) frame pairs.
+         */
+        public function get dirtyRanges():Array
+        {
+            return _dirtyRanges;
+        }
+        
+        /**
+         * Forget all dirty ranges. Called by the AudioPerformer after a bounce.
+         */
+        public function clearDirtyRanges():void
+        {
+            _dirtyRanges = [];
         }
         
         /**
@@ -103,14 +210,18 @@ package com.noteflight.standingwave3.performance
         /**
          * @inheritDoc 
          */        
-        public function getElementsInRange(start:Number, end:Number):Vector.<PerformableAudioSource>
+        public function getElementsInRange(start:Number, end:Number, result:Vector.<PerformableAudioSource> = null):Vector.<PerformableAudioSource>
         {
             // This makes use of _lastIndex as a memory of what was last queried to optimize
             // the search for the first matching element, since queries will in general run
             // in forward order.
             //
             var el:Vector.<PerformableAudioSource> = elements;
-            var result:Vector.<PerformableAudioSource> = new Vector.<PerformableAudioSource>();             
+            if (result) {
+                result.length = 0;
+            } else {
+                result = new Vector.<PerformableAudioSource>();
+            }
             _lastIndex = Math.max(0, Math.min(_lastIndex, el.length - 1));
 
             // back up if prior element is ahead of starting frame
@@ -133,6 +244,26 @@ package com.noteflight.standingwave3.performance
 
             return result;
         }
+        
+        /**
+         * Obtain a list of elements, ordered by start, that are sounding anywhere within a range.
+         * Unlike getElementsInRange(), this includes elements that began before the range. 
+         * 
+         * @param start frame count of range start (inclusive)
+         * @param end frame count of the range end (exclusive)
+         */
+        public function getElementsOverlappingRange(start:Number, end:Number):Vector.<PerformableAudioSource>
+        {
+            var el:Vector.<PerformableAudioSource> = elements;
+            var result:Vector.<PerformableAudioSource> = new Vector.<PerformableAudioSource>();
+            for (var i:int = 0; i < el.length && el[i].start < end; i++)
+            {
+                if (el[i].end > start) {
+                    result.push(el[i]);
+                }
+            }
+            return result;
+        }
 
         public function clone():IPerformance
         {
@@ -0,0 +1,198 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  NOTEFLIGHT LLC
+//  Copyright 2009 Noteflight LLC
+// 
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+package com.noteflight.standingwave3.performance
+{
+    import com.noteflight.standingwave3.elements.*;
+    
+    /**
+     * A MixBus is a named submix inside an AudioPerformer. Elements whose bus is set to its name
+     * are mixed into it instead of into the performer's output, and its effect chain then runs once
+     * per block over the whole submix, so one echo or tone filter can serve every note of an instrument.
+     * A bus mixes into its output bus, or into the performer's output if output is null.
+     * 
+     * Create buses with AudioPerformer.createBus(), and build the effect chain on the bus input, as in
+     * <code>bus.effect = new EchoFilter(new ToneControlFilter(bus.input), 0.375);</code>
+     */
+    public class MixBus
+    {
+        /** The name that elements and other buses route to */
+        public var name:String;
+        
+        /** The name of the bus this one mixes into, or null for the performer's output */
+        public var output:String;
+        
+        /** Gain in decibels applied as the bus is mixed into its output */
+        public var gain:Number;
+        
+        /** 
+         * The end of this bus's effect chain, built on input, or null to pass the submix straight through.
+         * Effects keep running after the elements on the bus have ended, so tails ring out.
+         */
+        public var effect:IAudioSource;
+        
+        private var _input:BusInput;
+        
+        /** The submix being accumulated for the current block, kept from block to block when reused */
+        internal var block:Sample;
+        
+        /**
+         * Use AudioPerformer.createBus() rather than constructing buses directly.
+         * @param input the input of the bus being cloned, if any
+         */
+        public function MixBus(name:String, descriptor:AudioDescriptor, output:String = null, gain:Number = 0, input:IAudioSource = null)
+        {
+            this.name = name;
+            this.output = output;
+            this.gain = gain;
+            _input = input ? BusInput(input) : new BusInput(descriptor);
+        }
+        
+        /**
+         * The source that the effect chain pulls the submix from.
+         */
+        public function get input():IAudioSource
+        {
+            return _input;
+        }
+        
+        /**
+         * Start a new block of submix.
+         * @param reuse whether to clear and reuse the last block rather than allocate a new one
+         */
+        internal function begin(numFrames:Number, reuse:Boolean = false):void
+        {
+            if (reuse) {
+                block = AudioPerformer.scratchBlock(block, _input.descriptor, numFrames);
+                block.setSamples(0, 0, numFrames);
+            } else {
+                block = new Sample(_input.descriptor, numFrames);
+            }
+        }
+        
+        /**
+         * Run the block's submix through the effect chain. The caller owns the result, unless it is
+         * the block itself being kept for reuse.
+         */
+        internal function render(numFrames:Number, reuse:Boolean = false):Sample
+        {
+            var result:Sample = block;
+            if (effect) {
+                _input.pending = result;
+                result = effect.getSample(numFrames);
+            }
+            if (!reuse || block.evicted) {
+                // Not kept, or destroyed by an effect that returned a new sample in its place
+                block = null;
+            }
+            return result;
+        }
+        
+        /**
+         * Free a block kept for reuse.
+         */
+        internal function releaseBlock():void
+        {
+            if (block) {
+                AudioPerformer.discardBlock(block);
+                block = null;
+            }
+        }
+        
+        /**
+         * Reset the effect chain, clearing any tails.
+         */
+        public function resetPosition():void
+        {
+            releaseBlock();
+            if (effect) {
+                effect.resetPosition();
+            } else {
+                _input.resetPosition();
+            }
+        }
+        
+        /**
+         * A copy of this bus with a cloned effect chain. The clone shares the input of this bus,
+         * since cloning the chain clones every source in it down to the input.
+         */
+        public function clone():MixBus
+        {
+            var bus:MixBus = new MixBus(name, _input.descriptor, output, gain, _input);
+            if (effect) {
+                bus.effect = effect.clone();
+            }
+            return bus;
+        }
+    }
+}
+
+import com.noteflight.standingwave3.elements.*;
+
+/**
+ * The source at the head of a bus's effect chain, which hands over each block of submix in turn.
+ */
+class BusInput implements IAudioSource
+{
+    /** The block to be returned by the next getSample() */
+    public var pending:Sample;
+    
+    private var _descriptor:AudioDescriptor;
+    private var _position:Number = 0;
+    
+    public function BusInput(descriptor:AudioDescriptor)
+    {
+        _descriptor = descriptor;
+    }
+    
+    public function get descriptor():AudioDescriptor
+    {
+        return _descriptor;
+    }
+    
+    public function get frameCount():Number
+    {
+        return int.MAX_VALUE;
+    }
+    
+    public function get position():Number
+    {
+        return _position;
+    }
+    
+    public function resetPosition():void
+    {
+        _position = 0;
+    }
+    
+    public function getSample(numFrames:Number):Sample
+    {
+        var sample:Sample = pending;
+        pending = null;
+        if (!sample || sample.frameCount != numFrames) {
+            // An effect asked for audio out of step with the block being mixed
+            throw new Error("Bus effects must pull exactly one block per block mixed.");
+        }
+        _position += numFrames;
+        return sample;
+    }
+    
+    public function clone():IAudioSource
+    {
+        // Cloned chains stay attached to the same bus input
+        return this;
+    }
+}
@@ -32,6 +32,9 @@ package com.noteflight.standingwave3.performance
         /** Optimal pan position (-1 to 1) for this element. Defaults to 0, center panned. */
         public var pan:Number; 
         
+        /** The name of the AudioPerformer MixBus to mix this element into, or null for the performer's output. */
+        public var bus:String;
+        
         /**
          * Create a PerformableAudioSource that renders the given source at a particular time onset. 
          * @param start a time onset within the performance in seconds from the time origin
@@ -0,0 +1,124 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  NOTEFLIGHT LLC
+//  Copyright 2009 Noteflight LLC
+// 
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+package com.noteflight.standingwave3.performance
+{
+    import com.noteflight.standingwave3.elements.*;
+    
+    /**
+     * A SegmentedBounce renders a long performance a segment at a time, so that an export can be
+     * spread over many frames or timer ticks without stalling the player.
+     * 
+     * The segments are rendered in order by one performer, which carries on from where the last
+     * segment left off, so each frame is rendered once and the result is identical to a bounce().
+     * Flash gives us one thread, so nothing is rendered concurrently.
+     * 
+     * Don't use the performer for anything else until the bounce is complete, or call cancel() first.
+     */
+    public class SegmentedBounce
+    {
+        /** The default segment length, in frames */
+        public static const SEGMENT_FRAMES:Number = 64 * AudioPerformer.BOUNCE_FRAMES;
+        
+        private var _performer:AudioPerformer;
+        private var _segmentFrames:Number;
+        private var _result:Sample;
+        private var _next:int = 0;
+        
+        /**
+         * Create a SegmentedBounce.
+         * @param performer the performer to render
+         * @param segmentFrames the length of each segment, rounded up to a multiple of AudioPerformer.BOUNCE_FRAMES
+         */
+        public function SegmentedBounce(performer:AudioPerformer, segmentFrames:Number = SEGMENT_FRAMES)
+        {
+            _performer = performer;
+            _segmentFrames = Math.max(1, Math.ceil(segmentFrames / AudioPerformer.BOUNCE_FRAMES)) * AudioPerformer.BOUNCE_FRAMES;
+            _result = new Sample(performer.descriptor, performer.frameCount);
+        }
+        
+        /** The number of segments */
+        public function get segmentCount():int
+        {
+            return Math.ceil(_performer.frameCount / _segmentFrames);
+        }
+        
+        /** The first frame of a segment */
+        public function segmentStart(index:int):Number
+        {
+            return index * _segmentFrames;
+        }
+        
+        /** The frame after the last frame of a segment */
+        public function segmentEnd(index:int):Number
+        {
+            return Math.min(_performer.frameCount, (index + 1) * _segmentFrames);
+        }
+        
+        /**
+         * Render the next segment into the result.
+         * @return true once every segment is in place
+         */
+        public function step():Boolean
+        {
+            if (complete) {
+                return true;
+            }
+            if (_next == 0) {
+                _performer.startBounce();
+            }
+            _performer.continueBounce(_result, segmentEnd(_next));
+            _next++;
+            if (complete) {
+                _performer.finishBounce();
+            }
+            return complete;
+        }
+        
+        /**
+         * Abandon the bounce, returning the performer to the start for playback.
+         * The result holds the segments rendered so far.
+         */
+        public function cancel():void
+        {
+            if (_next > 0 && !complete) {
+                _performer.finishBounce();
+            }
+            _next = segmentCount;
+        }
+        
+        /** True once every segment has been rendered */
+        public function get complete():Boolean
+        {
+            return _next >= segmentCount;
+        }
+        
+        /** The fraction of segments rendered so far */
+        public function get progress():Number
+        {
+            return (segmentCount == 0) ? 1 : Math.min(1, _next / segmentCount);
+        }
+        
+        /**
+         * The rendered performance, which is complete once complete is true.
+         * It belongs to the caller, who should destroy it when done.
+         */
+        public function get result():Sample
+        {
+            return _result;
+        }
+    }
+}
@@ -20,7 +20,7 @@ package com.noteflight.standingwave3.sources
 	/** 
 	 * Creates an audio source of indefinite duration by looping another IDirectAccessSource.
  	 */
-	public class LoopSource extends AbstractSource 
+	public class LoopSource extends AbstractSource implements IBufferedSource
 	{
 		/** The frame to begin and end looping on.
 		 * Standing Wave can *not* read loop points from samples. You must provide them.
@@ -87,6 +87,15 @@ package com.noteflight.standingwave3.sources
 		override public function getSample(numFrames:Number):Sample 
 		{
 			var sample:Sample = new Sample(descriptor, numFrames, false);
+			renderInto(sample, numFrames);
+			return sample;
+		}
+		
+		/**
+		 * @inheritDoc
+		 */
+		public function renderInto(sample:Sample, numFrames:Number):void 
+		{
 			var tableSize:Number;
 			
 			if (endFrame) {
@@ -127,8 +136,6 @@ package com.noteflight.standingwave3.sources
 			_phase = sample.wavetableInDirectAccessSource(_generator, tableSize, _phase, phaseAdd, phaseReset, 0, numFrames);
 			_position += numFrames;  
 			
-			return sample;
-			
 		}
 		
 		override public function clone():IAudioSource
@@ -15,27 +15,104 @@
 
 package com.noteflight.standingwave3.sources
 {
-	import com.noteflight.standingwave3.elements.AudioDescriptor;
-	import __AS3__.vec.Vector;
+	import com.noteflight.standingwave3.elements.*;
 	
-	public class NoiseSource extends AbstractSource
+	/**
+	 * A NoiseSource provides white or pink noise, generated natively straight into sample memory
+	 * by a xorshift generator. Each channel is independent. Every source gets its own seed, so
+	 * overlapping voices don't sound alike, and its noise is the same every time it is reset,
+	 * so renders are repeatable.
+	 */
+	public class NoiseSource extends AbstractSource implements IBufferedSource, IReleasableSource
 	{
-		public function NoiseSource(descriptor:AudioDescriptor, duration:Number=MAX_DURATION, amplitude:Number=1.0)
+		/** Noise colors, matching the constants in libawave.h */
+		public static const WHITE:int = 0;
+		public static const PINK:int = 1;
+		
+		/** The noise color, WHITE or PINK */
+		public var color:int;
+		
+		/** Generator state, Sample.NOISE_STATE frames per channel */
+		private var _state:Sample;
+		
+		/** The seed this source's noise starts from */
+		private var _seed:uint;
+		
+		/** The seed handed to the next source constructed without one */
+		private static var _nextSeed:uint = 1;
+		
+		/**
+		 * @param seed the noise stream to generate; 0 takes a different one for each new source
+		 */
+		public function NoiseSource(descriptor:AudioDescriptor, duration:Number=MAX_DURATION, amplitude:Number=1.0, color:int=WHITE, seed:uint=0)
 		{
 			super(descriptor, duration, amplitude);
+			this.color = color;
+			_seed = seed ? seed : _nextSeed++;
 		}
 		
-		override protected function generateChannel(data:Vector.<Number>, channel:Number, numFrames:Number):void
-        {
-        	// Naive noise source. Neither band-limited nor spectrum-shaped.
-        	// TODO: Provide band-limited white, pink, brown, gaussian, etc noise sources
-        	
-        	var twiceA:Number = amplitude * 2;
-            for (var i:int=0; i<numFrames; i++) {
-            	data[i] = (Math.random()-0.5) * twiceA;
-            }
-            
-        }
+		/** The seed this source's noise starts from */
+		public function get seed():uint
+		{
+			return _seed;
+		}
+		
+		override public function resetPosition():void
+		{
+			super.resetPosition();
+			if (_state) {
+				_state.seedNoise(_seed);
+			}
+		}
+		
+		override public function getSample(numFrames:Number):Sample
+		{
+			var sample:Sample = new Sample(descriptor, numFrames, false);
+			renderInto(sample, numFrames);
+			return sample;
+		}
+		
+		/**
+		 * @inheritDoc
+		 */
+		public function renderInto(sample:Sample, numFrames:Number):void
+		{
+			if (!_state) {
+				_state = new Sample(new AudioDescriptor(AudioDescriptor.RATE_44100, AudioDescriptor.CHANNELS_MONO), 
+					Sample.NOISE_STATE * descriptor.channels, true);
+				_state.memoryCategory = Sample.MEMORY_SCRATCH;
+				_state.seedNoise(_seed);
+			}
+			sample.noise(_state, color, amplitude);
+			_position += numFrames;
+		}
+		
+		/**
+		 * Free the generator state until the next render needs it again, which restarts the noise.
+		 */
+		public function releaseState():void
+		{
+			destroy();
+		}
+		
+		/**
+		 * Free the native generator state.
+		 */
+		public function destroy():void
+		{
+			if (_state) {
+				_state.destroy();
+				_state = null;
+			}
+		}
+		
+		/**
+		 * The clone takes a new seed, so that it does not double this source's noise.
+		 */
+		override public function clone():IAudioSource
+		{
+			return new NoiseSource(descriptor, duration, amplitude, color);
+		}
 		
 	}
-}
\ No newline at end of file
+}
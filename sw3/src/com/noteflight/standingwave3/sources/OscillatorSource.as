@@ -0,0 +1,101 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  NOTEFLIGHT LLC
+//  Copyright 2009 Noteflight LLC
+// 
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+package com.noteflight.standingwave3.sources
+{
+    import com.noteflight.standingwave3.elements.*;
+    
+    /**
+     * An OscillatorSource provides a source whose signal in all channels is a basic waveform of a given frequency.
+     * The waveform is generated natively, straight into sample memory. Saw, square and triangle waves
+     * are band-limited with PolyBLEP, which keeps aliasing low without the cost of a wavetable per pitch.
+     */
+    public class OscillatorSource extends AbstractSource implements IBufferedSource
+    {
+    	/** Waveforms, matching the constants in libawave.h */
+    	public static const SINE:int = 0;
+    	public static const SAW:int = 1;
+    	public static const SQUARE:int = 2;
+    	public static const TRIANGLE:int = 3;
+    	
+        protected var _frequency:Number = 0;
+        protected var _phase:Number = 0;
+        protected var _wave:int;
+
+        public function OscillatorSource(descriptor:AudioDescriptor, duration:Number, frequency:Number, 
+        	wave:int = SAW, amplitude:Number = 0.5)
+        {
+            super(descriptor, duration, amplitude);
+            this.frequency = frequency;
+            this.wave = wave;
+        }
+
+        /**
+         * The frequency of this waveform. 
+         */
+        public function get frequency():Number
+        {
+            return _frequency;
+        }
+        
+        public function set frequency(value:Number):void
+        {
+            _frequency = value;
+        }
+        
+        /**
+         * The waveform, one of SINE, SAW, SQUARE or TRIANGLE.
+         */
+        public function get wave():int
+        {
+            return _wave;
+        }
+        
+        public function set wave(value:int):void
+        {
+            _wave = value;
+        }
+        
+        override public function resetPosition():void
+        {
+            super.resetPosition();
+            _phase = 0;
+        }
+        
+        override public function getSample(numFrames:Number):Sample
+        {
+            var sample:Sample = new Sample(descriptor, numFrames, false);
+            renderInto(sample, numFrames);
+            return sample; 
+        }
+        
+        /**
+         * @inheritDoc
+         */
+        public function renderInto(sample:Sample, numFrames:Number):void
+        {
+            // The phase carries over between calls, to avoid discontinuities
+            _phase = sample.oscillator(_wave, _phase, _frequency / _descriptor.rate, amplitude);
+            _position += numFrames;
+        }
+        
+        override public function clone():IAudioSource
+        {
+            return new OscillatorSource(descriptor, duration, frequency, wave, amplitude);
+        }
+        
+    }
+}
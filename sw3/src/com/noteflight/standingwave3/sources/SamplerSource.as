@@ -9,7 +9,7 @@ package com.noteflight.instruments
      * complex sample wavetable playback functionality.
      * It has flexible start and loop points, and accepts pitch modulations.
      */
-    public class SamplerSource extends AbstractSource 
+    public class SamplerSource extends AbstractSource implements IBufferedSource, IReleasableSource
     {
         
         /** A direct access source to serve as the source of raw sample data */
@@ -37,6 +37,9 @@ package com.noteflight.instruments
         /** The pitch bend data */
         protected var _pitchModulationData:LineData;
         
+        /** This voice's read position in the pitch bend data */
+        protected var _pitchCursor:ModulationCursor;
+        
         protected var _phase:Number;
         
         private static const LOOP_MAX:Number = 30;
@@ -56,12 +59,14 @@ package com.noteflight.instruments
             this.pitchModulations = new Array();
             this._realizedModulations = new Array();
             this._pitchModulationData = new LineData();
+            this._pitchCursor = new ModulationCursor(_pitchModulationData);
         }
         
         override public function resetPosition():void 
         {
             _phase = 0;
             _position = 0;
+            _pitchCursor.reset();
         }
         
         /**
@@ -87,13 +92,21 @@ package com.noteflight.instruments
         }
 
         override public function getSample(numFrames:Number):Sample 
+        {
+            var sample:Sample = new Sample(descriptor, numFrames, false);
+            renderInto(sample, numFrames);
+            return sample;
+        }
+        
+        /**
+         * @inheritDoc
+         */
+        public function renderInto(sample:Sample, numFrames:Number):void 
         {
             // First realize any outstanding modulations
             
             realizeModulationData();
-            var segments:Array = _pitchModulationData.getSegments(position, position+numFrames-1);
             
-            var sample:Sample = new Sample(descriptor, numFrames, false);
             var tableSize:Number;
             
             if (endFrame) {
@@ -129,27 +142,14 @@ package com.noteflight.instruments
             // Make sure the sound generator is filled to the max time we will need, plus a guard sample for interpolation
             _generator.fill( Math.ceil(_position / actualShift) + 1 );
             
-            // Loop over all the segments in this window.
-            // Each segment represents a change in keyframe to pitch modulation
-            // Scan the wavetable forward, looping appropriately
+            // Scan the wavetable forward, looping appropriately, with the pitch modulation
+            // read frame by frame through our cursor.
             // The wavetable function returns the new phase (ie position in the generator)
             
-            var segmentFrames:int;
-            var offset:int;
-            var pitchMod:Mod;
-            
-            for (var s:int=0; s<segments.length; s += 2) {
-                // trace("Segment " + segments[s] + " to " + segments[s+1]);
-                segmentFrames = segments[s+1] - segments[s] + 1; // length of segment
-                offset = segments[s] - position; // offset in result sample to composite into
-                pitchMod = _pitchModulationData.getModForRange(segments[s], segments[s+1]);
-                _phase = sample.wavetableInDirectAccessSource(_generator, tableSize, _phase, phaseAdd, phaseReset, offset, segmentFrames, pitchMod);
-            }
+            _phase = sample.wavetableInCurveDirectAccessSource(_generator, tableSize, _phase, phaseAdd, phaseReset, 0, numFrames, _pitchCursor);
             
             _position += numFrames;  
             
-            return sample;
-            
         }
         
         protected function realizeModulationData():void
@@ -164,6 +164,22 @@ package com.noteflight.instruments
             }
         }
         
+        /**
+         * Free the native pitch modulation curve.
+         */
+        public function destroy():void
+        {
+            _pitchModulationData.destroy();
+        }
+        
+        /**
+         * Free the native pitch modulation curve until the next render needs it again.
+         */
+        public function releaseState():void
+        {
+            _pitchModulationData.destroy();
+        }
+        
         override public function clone():IAudioSource
         {
             var rslt:SamplerSource = new SamplerSource(_descriptor, _generator);
@@ -56,11 +56,14 @@ package com.noteflight.standingwave3.utils
         * Convert a pan position into left and right amplitude factors.
         * @param pan the pan position from left -1 to center 0 to right -1
         * @param panLaw the db down at center, defaults to -3db
+        * @param rslt an object to set the factors on, instead of a new one
         * @returns an object with left and right values set to amp factors
         */
-        public static function panToFactors(pan:Number, panLaw:Number=-3):Object 
+        public static function panToFactors(pan:Number, panLaw:Number=-3, rslt:Object=null):Object 
         {
-        	var rslt:Object = new Object();
+        	if (!rslt) {
+        		rslt = new Object();
+        	}
         	var plf:Number = AudioUtils.decibelsToFactor(panLaw);
 			if (pan < -1) { pan = -1; }
 			if (pan > 1) { pan = 1; }